@@ -2,6 +2,75 @@
 // Add two bitsets represented as arrays of long long
 // Useful for subset sum DP optimization
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Fused kernel for dp |= dp << value on words [lo, hi) of src, written to dst.
+// Walks words from high to low, so dst == src is safe (in-place, no temporary).
+// The AVX2/AVX-512 versions are picked once at runtime, scalar is the fallback.
+void shift_or_scalar(unsigned long long *dst, const unsigned long long *src,
+                     int lo, int hi, int value) {
+    int bs = value / 64, bit = value % 64;
+    for (int i = hi - 1; i >= lo; --i) {
+        unsigned long long v = src[i];
+        if (i >= bs) {
+            v |= src[i - bs] << bit;
+            if (bit && i > bs) v |= src[i - bs - 1] >> (64 - bit);
+        }
+        dst[i] = v;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void shift_or_avx2(unsigned long long *dst, const unsigned long long *src,
+                   int lo, int hi, int value) {
+    int bs = value / 64, bit = value % 64, i = hi;
+    // a shift count of 64 gives 0, so bit == 0 needs no special case
+    __m128i sl = _mm_cvtsi32_si128(bit), sr = _mm_cvtsi32_si128(64 - bit);
+    for (; i - 4 >= max(lo, bs + 1); i -= 4) {
+        __m256i cur = _mm256_loadu_si256((const __m256i *)(src + i - 4));
+        __m256i x = _mm256_loadu_si256((const __m256i *)(src + i - 4 - bs));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(src + i - 5 - bs));
+        x = _mm256_or_si256(_mm256_sll_epi64(x, sl), _mm256_srl_epi64(y, sr));
+        _mm256_storeu_si256((__m256i *)(dst + i - 4), _mm256_or_si256(cur, x));
+    }
+    shift_or_scalar(dst, src, lo, i, value);
+}
+
+__attribute__((target("avx512f")))
+void shift_or_avx512(unsigned long long *dst, const unsigned long long *src,
+                     int lo, int hi, int value) {
+    int bs = value / 64, bit = value % 64, stop = max(lo, bs + 1);
+    __m128i sl = _mm_cvtsi32_si128(bit), sr = _mm_cvtsi32_si128(64 - bit);
+    // the last step is masked down to the i - stop < 8 words left; maskz
+    // forms throughout, the plain shifts merge into an undefined vector
+    for (int i = hi; i > stop; i -= 8) {
+        int w = min(8, i - stop), at = i - w;
+        __mmask8 m = (1 << w) - 1;
+        __m512i cur = _mm512_maskz_loadu_epi64(m, src + at);
+        __m512i x = _mm512_maskz_loadu_epi64(m, src + at - bs);
+        __m512i y = _mm512_maskz_loadu_epi64(m, src + at - 1 - bs);
+        x = _mm512_or_si512(_mm512_maskz_sll_epi64(m, x, sl), _mm512_maskz_srl_epi64(m, y, sr));
+        _mm512_mask_storeu_epi64(dst + at, m, _mm512_or_si512(cur, x));
+    }
+    shift_or_scalar(dst, src, lo, min(hi, stop), value);
+}
+#endif
+
+typedef void (*ShiftOrKernel)(unsigned long long *, const unsigned long long *, int, int, int);
+
+ShiftOrKernel shift_or_kernel() {
+#if defined(__x86_64__) || defined(__i386__)
+    static ShiftOrKernel fn = __builtin_cpu_supports("avx512f") ? shift_or_avx512 :
+                              __builtin_cpu_supports("avx2") ? shift_or_avx2 : shift_or_scalar;
+    return fn;
+#else
+    return shift_or_scalar;
+#endif
+}
+
 template<int MAXN>
 struct BitsetAdd {
     static const int BLOCK = 64;
@@ -53,6 +122,13 @@ struct BitsetAdd {
         }
     }
     
+    // dp |= dp << value in one backward pass, no temporary
+    void shift_or(int value) {
+        if (value <= 0 || value >= MAXN) return;
+        shift_or_kernel()(a, a, 0, SIZE, value);
+        if (MAXN % BLOCK) a[SIZE - 1] &= (1ULL << (MAXN % BLOCK)) - 1;
+    }
+    
     // OR operation
     BitsetAdd operator|(const BitsetAdd &other) const {
         BitsetAdd result;
@@ -108,12 +184,344 @@ struct BitsetAdd {
     }
 };
 
+// Roaring-style BitsetAdd for sparse sets (early DP phase, large weights).
+// The range is cut into 2^16-bit chunks, each one empty, a sorted array of
+// at most LIMIT offsets, or WORDS dense words. Chunks switch automatically,
+// so count/first/add/|= cost O(set bits + dense words), not O(MAXN / 64).
+template<int MAXN>
+struct SparseBitsetAdd {
+    static const int CHUNK = 1 << 16, WORDS = CHUNK / 64, LIMIT = 4096;
+    static const int NCHUNK = (MAXN + CHUNK - 1) / CHUNK;
+
+    struct Container {
+        vector<unsigned short> arr;
+        vector<unsigned long long> bits; // non-empty iff dense
+        int card = 0;
+
+        bool dense() const { return !bits.empty(); }
+
+        void to_dense() {
+            bits.assign(WORDS, 0);
+            for (int x : arr) bits[x >> 6] |= 1ULL << (x & 63);
+            vector<unsigned short>().swap(arr);
+        }
+
+        void to_array() {
+            arr.clear();
+            arr.reserve(card);
+            for (int i = 0; i < WORDS; ++i) {
+                for (unsigned long long w = bits[i]; w; w &= w - 1) {
+                    arr.push_back(i * 64 + __builtin_ctzll(w));
+                }
+            }
+            vector<unsigned long long>().swap(bits);
+        }
+
+        bool test(int x) const {
+            if (dense()) return (bits[x >> 6] >> (x & 63)) & 1;
+            return binary_search(arr.begin(), arr.end(), (unsigned short) x);
+        }
+
+        void set(int x) {
+            if (dense()) {
+                or_word(x >> 6, 1ULL << (x & 63));
+                return;
+            }
+            auto it = lower_bound(arr.begin(), arr.end(), (unsigned short) x);
+            if (it != arr.end() && *it == x) return;
+            arr.insert(it, x);
+            if (++card > LIMIT) to_dense();
+        }
+
+        // x must be larger than every offset already in an array container
+        void push(int x) {
+            if (dense()) {
+                or_word(x >> 6, 1ULL << (x & 63));
+                return;
+            }
+            arr.push_back(x);
+            if (++card > LIMIT) to_dense();
+        }
+
+        void or_word(int w, unsigned long long v) {
+            if (!v) return;
+            if (!dense()) to_dense();
+            card += __builtin_popcountll(v & ~bits[w]);
+            bits[w] |= v;
+        }
+
+        void unite(const Container &o) {
+            if (!o.card) return;
+            if (o.dense()) {
+                if (!dense()) to_dense();
+                card = 0;
+                for (int i = 0; i < WORDS; ++i) {
+                    bits[i] |= o.bits[i];
+                    card += __builtin_popcountll(bits[i]);
+                }
+            } else if (dense()) {
+                for (int x : o.arr) or_word(x >> 6, 1ULL << (x & 63));
+            } else {
+                vector<unsigned short> res;
+                res.reserve(arr.size() + o.arr.size());
+                set_union(arr.begin(), arr.end(), o.arr.begin(), o.arr.end(), back_inserter(res));
+                arr.swap(res);
+                card = arr.size();
+                if (card > LIMIT) to_dense();
+            }
+        }
+    };
+
+    vector<Container> c;
+
+    SparseBitsetAdd() : c(NCHUNK) {}
+
+    void set(int pos) {
+        c[pos >> 16].set(pos & (CHUNK - 1));
+    }
+
+    bool test(int pos) const {
+        return c[pos >> 16].test(pos & (CHUNK - 1));
+    }
+
+    void reset() {
+        c.assign(NCHUNK, Container());
+    }
+
+    // ORs v into global word q, dropping bits >= MAXN
+    void or_global_word(long long q, unsigned long long v) {
+        if (q * 64 >= MAXN) return;
+        if (q * 64 + 64 > MAXN) v &= (1ULL << (MAXN - q * 64)) - 1;
+        c[q / WORDS].or_word(q % WORDS, v);
+    }
+
+    // Add value to all set bits (shift left by value positions)
+    void add(int value) {
+        if (value == 0) return;
+        SparseBitsetAdd res;
+        for (int i = 0; i < NCHUNK; ++i) {
+            const Container &src = c[i];
+            long long base = (long long) i * CHUNK + value;
+            if (!src.card || base >= MAXN) continue;
+            if (!src.dense()) {
+                // chunks are walked in increasing order, so targets see ascending pushes
+                for (int x : src.arr) {
+                    long long p = base + x;
+                    if (p >= MAXN) break;
+                    res.c[p >> 16].push(p & (CHUNK - 1));
+                }
+            } else {
+                int off = base & 63;
+                for (int w = 0; w < WORDS; ++w) {
+                    unsigned long long v = src.bits[w];
+                    if (!v) continue;
+                    long long q = (base + w * 64) >> 6;
+                    res.or_global_word(q, v << off);
+                    if (off) res.or_global_word(q + 1, v >> (64 - off));
+                }
+            }
+        }
+        for (auto &x : res.c) {
+            if (x.dense() && x.card <= LIMIT) x.to_array();
+        }
+        c.swap(res.c);
+    }
+
+    // dp |= dp << value without a shifted copy, cost proportional to the
+    // number of set bits plus dense words. Chunks are walked from the top, so
+    // every target above chunk i has already given away its own bits; a dense
+    // chunk shifting inside itself goes through shift_or_kernel in place.
+    void shift_or(int value) {
+        if (value <= 0 || value >= MAXN) return;
+        int cs = value / CHUNK, r = value % CHUNK;
+        for (int i = NCHUNK - 1; i >= 0; --i) {
+            Container &src = c[i];
+            long long base = (long long) i * CHUNK + value;
+            if (!src.card || base >= MAXN) continue;
+            if (!src.dense()) {
+                Container lo, hi; // offsets landing in chunks i + cs and i + cs + 1
+                for (int x : src.arr) {
+                    long long p = base + x;
+                    if (p >= MAXN) break;
+                    (p >> 16 == i + cs ? lo : hi).push(p & (CHUNK - 1));
+                }
+                if (hi.card) c[i + cs + 1].unite(hi);
+                c[i + cs].unite(lo);
+                continue;
+            }
+            // words reaching chunk i + cs + 1 (all of them when cs > 0) are ORed
+            // there before the kernel overwrites chunk i
+            long long split = (long long) (i + cs + 1) * WORDS;
+            int off = base & 63;
+            for (int w = WORDS - 1; w >= 0; --w) {
+                unsigned long long v = src.bits[w];
+                long long q = (base + w * 64) >> 6;
+                if (cs == 0 && q + 1 < split) break;
+                if (!v) continue;
+                if (cs > 0 || q >= split) or_global_word(q, v << off);
+                if (off) or_global_word(q + 1, v >> (64 - off));
+            }
+            if (cs > 0) continue;
+            shift_or_kernel()(src.bits.data(), src.bits.data(), 0, WORDS, r);
+            long long lim = MAXN - (long long) i * CHUNK;
+            if (lim < CHUNK) {
+                src.bits[lim >> 6] &= (1ULL << (lim & 63)) - 1;
+                fill(src.bits.begin() + (lim >> 6) + 1, src.bits.end(), 0);
+            }
+            src.card = 0;
+            for (int w = 0; w < WORDS; ++w) src.card += __builtin_popcountll(src.bits[w]);
+        }
+    }
+
+    SparseBitsetAdd& operator|=(const SparseBitsetAdd &other) {
+        for (int i = 0; i < NCHUNK; ++i) {
+            c[i].unite(other.c[i]);
+        }
+        return *this;
+    }
+
+    int count() const {
+        int cnt = 0;
+        for (auto &x : c) cnt += x.card;
+        return cnt;
+    }
+
+    int first() const {
+        for (int i = 0; i < NCHUNK; ++i) {
+            if (!c[i].card) continue;
+            if (!c[i].dense()) return i * CHUNK + c[i].arr[0];
+            for (int w = 0; w < WORDS; ++w) {
+                if (c[i].bits[w]) return i * CHUNK + w * 64 + __builtin_ctzll(c[i].bits[w]);
+            }
+        }
+        return -1;
+    }
+};
+
+// Runtime-sized BitsetAdd on a 64-byte aligned heap buffer.
+// top bounds the non-zero words, so shift_or only touches [0, top).
+// With threads > 1 each thread writes its own block range into a second
+// buffer (shifting in place across threads would race), then they swap.
+struct DynamicBitsetAdd {
+    static const int BLOCK = 64;
+    int n, size, top;
+    unsigned long long *a, *b;
+
+    static unsigned long long *alloc(int words) {
+        size_t bytes = ((size_t) max(words, 1) * 8 + 63) / 64 * 64;
+        return (unsigned long long *) aligned_alloc(64, bytes);
+    }
+
+    DynamicBitsetAdd(int _n) : n(_n), size((_n + BLOCK - 1) / BLOCK), top(0), b(0) {
+        a = alloc(size);
+        memset(a, 0, (size_t) size * 8);
+    }
+    DynamicBitsetAdd(const DynamicBitsetAdd &o) : n(o.n), size(o.size), top(o.top), b(0) {
+        a = alloc(size);
+        memcpy(a, o.a, (size_t) size * 8);
+    }
+    DynamicBitsetAdd& operator=(DynamicBitsetAdd o) {
+        swap(n, o.n); swap(size, o.size); swap(top, o.top);
+        swap(a, o.a); swap(b, o.b);
+        return *this;
+    }
+    ~DynamicBitsetAdd() { free(a); free(b); }
+
+    void set(int pos) {
+        a[pos / BLOCK] |= (1ULL << (pos % BLOCK));
+        top = max(top, pos / BLOCK + 1);
+    }
+
+    bool test(int pos) const {
+        return (a[pos / BLOCK] >> (pos % BLOCK)) & 1;
+    }
+
+    void reset() {
+        memset(a, 0, (size_t) size * 8);
+        if (b) memset(b, 0, (size_t) size * 8); // shift_or relies on b being clean past top
+        top = 0;
+    }
+
+    // dp |= dp << value, block ranges split over threads
+    void shift_or(int value, int threads = 1) {
+        if (value <= 0 || value >= n || top == 0) return;
+        int hi = (int) min((long long) size, (long long) top + value / BLOCK + 1);
+        ShiftOrKernel kernel = shift_or_kernel();
+        if (threads <= 1 || hi < (1 << 14)) {
+            kernel(a, a, 0, hi, value);
+        } else {
+            if (!b) {
+                b = alloc(size);
+                memset(b, 0, (size_t) size * 8);
+            }
+            // b only ever holds an older, smaller top, so b[hi, size) is zero
+            int step = ((hi + threads - 1) / threads + 7) / 8 * 8;
+            vector<thread> pool;
+            for (int lo = 0; lo < hi; lo += step) {
+                pool.emplace_back(kernel, b, a, lo, min(hi, lo + step), value);
+            }
+            for (auto &t : pool) t.join();
+            swap(a, b);
+        }
+        top = hi;
+        if (top == size && n % BLOCK) a[size - 1] &= (1ULL << (n % BLOCK)) - 1;
+    }
+
+    DynamicBitsetAdd& operator|=(const DynamicBitsetAdd &other) {
+        for (int i = 0; i < other.top; ++i) {
+            a[i] |= other.a[i];
+        }
+        top = max(top, other.top);
+        return *this;
+    }
+
+    int count() const {
+        int cnt = 0;
+        for (int i = 0; i < top; ++i) {
+            cnt += __builtin_popcountll(a[i]);
+        }
+        return cnt;
+    }
+
+    int first() const {
+        for (int i = 0; i < top; ++i) {
+            if (a[i]) {
+                return i * BLOCK + __builtin_ctzll(a[i]);
+            }
+        }
+        return -1;
+    }
+};
+
+// Bounded-multiplicity subset sum: items are (weight, count).
+// Equal weights are merged, then each count is split into 1, 2, 4, ..., rest,
+// so the number of shift_or passes is sum of log(count) per distinct weight.
+// Returns the set of reachable sums in [0, maxsum].
+DynamicBitsetAdd subset_sum(const vector<pair<int, long long>> &items, int maxsum, int threads = 1) {
+    map<int, long long> cnt;
+    for (auto &it : items) {
+        if (it.first > 0) cnt[it.first] += it.second;
+    }
+    DynamicBitsetAdd dp(maxsum + 1);
+    dp.set(0);
+    for (auto &it : cnt) {
+        long long w = it.first, c = min(it.second, (long long) maxsum / w);
+        for (long long k = 1; c > 0; k *= 2) {
+            long long take = min(k, c);
+            dp.shift_or(take * w, threads);
+            c -= take;
+        }
+    }
+    return dp;
+}
+
 // Example usage for subset sum
 // BitsetAdd<100001> dp;
 // dp.set(0);
 // for (int i = 0; i < n; ++i) {
-//     BitsetAdd<100001> tmp = dp;
-//     tmp.add(arr[i]);
-//     dp |= tmp;
+//     dp.shift_or(arr[i]); // same as tmp = dp; tmp.add(arr[i]); dp |= tmp;
 // }
+//
+// Sums up to 1e8 with repeated weights, 8 threads:
+// DynamicBitsetAdd dp = subset_sum({{3, 1000}, {7, 5}, {3, 20}}, 100000000, 8);
 
@@ -0,0 +1,144 @@
+// Memory-lean 2D Range Minimum/Maximum Query (row-blocked sparse table)
+// Same query(r1, c1, r2, c2) as SparseTable2D, for grids where the
+// O(N*M*log(N)*log(M)) table does not fit (4096 x 4096 ints: ~0.5 GB vs ~11 GB).
+// Rows are grouped in blocks of R. Every "line" (a length-M array) gets an
+// O(1) 1D RMQ: 32-column blocks with a monotonic-stack bitmask per cell
+// plus a sparse table over block results. Lines kept:
+//   - each row, each in-block prefix and suffix of rows  (3N lines)
+//   - a sparse table over row blocks                     (N/R * log(N/R) lines)
+// A query spanning several row blocks is suffix + prefix + two block lines
+// (O(1)); inside one block it scans at most R rows.
+// Preprocessing: O(N*M + N*M*log(N/R)/R), Space: same, Query: O(1) / O(R)
+
+template<typename T, typename Compare = less<T>> // greater<T> for max
+struct BlockedRMQ2D {
+    static const int R = 16;
+    int n, m, nb, mb, lm;
+    vector<T> val;         // line L is val[L * m, (L + 1) * m)
+    vector<unsigned> mask; // in-block stack of each cell, same layout as val
+    vector<T> bst;         // line L, level k, block b: bst[(L * lm + k) * mb + b]
+    vector<int> lvl;       // first line of row-block level k (k >= 1)
+    Compare comp;
+
+    T best(const T &a, const T &b) const {
+        return comp(b, a) ? b : a;
+    }
+
+    static int lg(int x) {
+        return 31 - __builtin_clz(x);
+    }
+
+    int row(int i) const { return i; }
+    int prefix(int i) const { return n + i; }     // rows (i / R) * R .. i
+    int suffix(int i) const { return 2 * n + i; } // rows i .. end of its block
+
+    // row blocks b .. b + 2^k - 1
+    int block_line(int k, int b) const {
+        return k ? lvl[k] + b : prefix(min(b * R + R - 1, n - 1));
+    }
+
+    void combine_lines(int dst, int x, int y) {
+        T *d = &val[(size_t) dst * m];
+        const T *a = &val[(size_t) x * m], *b = &val[(size_t) y * m];
+        for (int j = 0; j < m; ++j) d[j] = best(a[j], b[j]);
+    }
+
+    BlockedRMQ2D(vector<vector<T>> &a) {
+        n = a.size();
+        m = a[0].size();
+        nb = (n + R - 1) / R;
+        mb = (m + 31) / 32;
+        lm = lg(mb) + 1;
+        int lines = 3 * n;
+        lvl.assign(lg(nb) + 1, 0);
+        for (int k = 1; (1 << k) <= nb; ++k) {
+            lvl[k] = lines;
+            lines += nb - (1 << k) + 1;
+        }
+        val.resize((size_t) lines * m);
+        mask.resize((size_t) lines * m);
+        bst.resize((size_t) lines * lm * mb);
+
+        for (int i = 0; i < n; ++i) {
+            copy(a[i].begin(), a[i].end(), val.begin() + (size_t) row(i) * m);
+        }
+        for (int i = 0; i < n; ++i) {
+            if (i % R == 0) copy_n(val.begin() + (size_t) row(i) * m, m, val.begin() + (size_t) prefix(i) * m);
+            else combine_lines(prefix(i), prefix(i - 1), row(i));
+        }
+        for (int i = n - 1; i >= 0; --i) {
+            if (i % R == R - 1 || i == n - 1) copy_n(val.begin() + (size_t) row(i) * m, m, val.begin() + (size_t) suffix(i) * m);
+            else combine_lines(suffix(i), suffix(i + 1), row(i));
+        }
+        for (int k = 1; (1 << k) <= nb; ++k) {
+            for (int b = 0; b + (1 << k) <= nb; ++b) {
+                combine_lines(block_line(k, b), block_line(k - 1, b), block_line(k - 1, b + (1 << (k - 1))));
+            }
+        }
+        for (int L = 0; L < lines; ++L) build_line(L);
+    }
+
+    void build_line(int L) {
+        const T *v = &val[(size_t) L * m];
+        unsigned *mk = &mask[(size_t) L * m];
+        T *t = &bst[(size_t) L * lm * mb];
+        for (int s = 0; s < m; s += 32) {
+            unsigned cur = 0;
+            for (int j = s; j < min(m, s + 32); ++j) {
+                // pop while v[j] beats the newest stack entry
+                while (cur && comp(v[j], v[s + 31 - __builtin_clz(cur)])) cur ^= 1u << (31 - __builtin_clz(cur));
+                cur |= 1u << (j - s);
+                mk[j] = cur;
+            }
+            t[s / 32] = v[s + __builtin_ctz(cur)];
+        }
+        for (int k = 1; k < lm; ++k) {
+            for (int b = 0; b + (1 << k) <= mb; ++b) {
+                t[k * mb + b] = best(t[(k - 1) * mb + b], t[(k - 1) * mb + b + (1 << (k - 1))]);
+            }
+        }
+    }
+
+    // c1 and c2 in the same 32-column block
+    T in_block(int L, int c1, int c2) const {
+        int s = c1 & ~31;
+        unsigned mk = mask[(size_t) L * m + c2] & (~0u << (c1 - s));
+        return val[(size_t) L * m + s + __builtin_ctz(mk)];
+    }
+
+    T line_query(int L, int c1, int c2) const {
+        int b1 = c1 >> 5, b2 = c2 >> 5;
+        if (b1 == b2) return in_block(L, c1, c2);
+        T res = best(in_block(L, c1, b1 * 32 + 31), in_block(L, b2 * 32, c2));
+        if (b1 + 1 < b2) {
+            int k = lg(b2 - b1 - 1);
+            const T *t = &bst[((size_t) L * lm + k) * mb];
+            res = best(res, best(t[b1 + 1], t[b2 - (1 << k)]));
+        }
+        return res;
+    }
+
+    // Query rectangle [r1, r2] x [c1, c2] (0-indexed, inclusive)
+    T query(int r1, int c1, int r2, int c2) const {
+        int b1 = r1 / R, b2 = r2 / R;
+        if (b1 == b2) {
+            if (r1 % R == 0) return line_query(prefix(r2), c1, c2);
+            if (r2 % R == R - 1 || r2 == n - 1) return line_query(suffix(r1), c1, c2);
+            T res = line_query(row(r1), c1, c2);
+            for (int i = r1 + 1; i <= r2; ++i) res = best(res, line_query(row(i), c1, c2));
+            return res;
+        }
+        T res = best(line_query(suffix(r1), c1, c2), line_query(prefix(r2), c1, c2));
+        if (b1 + 1 < b2) {
+            int k = lg(b2 - b1 - 1);
+            res = best(res, line_query(block_line(k, b1 + 1), c1, c2));
+            res = best(res, line_query(block_line(k, b2 - (1 << k)), c1, c2));
+        }
+        return res;
+    }
+};
+
+// Example usage:
+// BlockedRMQ2D<int> rmq(a);               // min
+// BlockedRMQ2D<int, greater<int>> rmq(a); // max
+// int result = rmq.query(r1, c1, r2, c2);
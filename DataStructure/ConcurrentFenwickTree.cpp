@@ -0,0 +1,92 @@
+// Fenwick tree for many writer threads (same mul/add trick as FenwickTree)
+// Each writer thread is pinned round-robin to one of S shards, so writers on
+// different shards share no lock and rarely a cache line.
+// get() sums the matching prefix of every shard.
+//   LINEARIZABLE = false: writers take no lock but pay an atomic fetch_add
+//     per cell; get() may observe half of a concurrent update_range.
+//   LINEARIZABLE = true: writers lock their own shard (uncontended when
+//     threads <= S) and store without RMW; get() locks every shard in index
+//     order, so it sees a consistent cut. Usually the faster mode.
+// Only worth it when writers run on several cores at once and gets are rare
+// (a get costs S plain ones). On a single core a FenwickTree behind one mutex
+// is faster at every thread count; bench/ConcurrentFenwick.cpp measures both.
+// Space: O(S * N), Time: O(log N) per update, O(S * log N) per get
+
+template<typename T = long long, bool LINEARIZABLE = false>
+struct ConcurrentFenwickTree { // 1-based index
+    struct Cell {
+        atomic<T> mul, add;
+    };
+    struct alignas(64) Shard {
+        unique_ptr<Cell[]> t;
+        mutex mtx;
+    };
+    vector<unique_ptr<Shard>> shards;
+    int n;
+
+    ConcurrentFenwickTree(int _n, int S = thread::hardware_concurrency()): n (_n) {
+        for (int s = 0; s < max(S, 1); ++s) {
+            shards.emplace_back(new Shard());
+            shards.back()->t.reset(new Cell[n + 1]());
+        }
+    }
+
+    Shard &my_shard() {
+        static atomic<int> next(0);
+        static thread_local int id = next++;
+        return *shards[id % shards.size()];
+    }
+
+    // under LINEARIZABLE the shard lock excludes other writers, so a plain
+    // load + store replaces the locked read-modify-write
+    static void bump(atomic<T> &a, T v) {
+        if (LINEARIZABLE) a.store(a.load(memory_order_relaxed) + v, memory_order_relaxed);
+        else a.fetch_add(v, memory_order_relaxed);
+    }
+
+    void update_point(Cell *t, int x, T mul, T add) {
+        while (1<=x && x<=n) {
+            bump(t[x].mul, mul);
+            bump(t[x].add, add);
+            x+=x&(-x);
+        }
+    }
+
+    void update_point(int x, T mul, T add) {
+        Shard &s = my_shard();
+        unique_lock<mutex> lock(s.mtx, defer_lock);
+        if (LINEARIZABLE) lock.lock();
+        update_point(s.t.get(), x, mul, add);
+    }
+
+    void update_range(int l, int r, T val) { // l to r (inclusive)
+        Shard &s = my_shard();
+        unique_lock<mutex> lock(s.mtx, defer_lock);
+        if (LINEARIZABLE) lock.lock();
+        update_point(s.t.get(), l,val,-val*(l-1));
+        update_point(s.t.get(), r,-val,val*r);
+    }
+
+    T get(int x) {
+        // shards are always locked in index order, so two readers cannot deadlock
+        if (LINEARIZABLE) for (auto &s : shards) s->mtx.lock();
+        T mul = 0, add = 0;
+        for (auto &s : shards) {
+            for (int y = x; 1<=y && y<=n; y&=y-1) {
+                mul+=s->t[y].mul.load(memory_order_relaxed);
+                add+=s->t[y].add.load(memory_order_relaxed);
+            }
+        }
+        if (LINEARIZABLE) for (auto &s : shards) s->mtx.unlock();
+        return (mul*x+add);
+    }
+
+    T value(int x) {
+        return (get(x)-get(x-1));
+    }
+};
+
+// Example usage:
+// ConcurrentFenwickTree<long long, true> ft(n, 8);
+// each worker thread: ft.update_range(l, r, val);
+// any thread: ft.get(x) - ft.get(l - 1)
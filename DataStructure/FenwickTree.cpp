@@ -1,35 +1,121 @@
+// mul and add of a node share one cell, so every step touches one cache line
+// (pays off once the tree no longer fits in cache).
+template<typename T = long long>
 struct FenwickTree { // 1-based index
-    vector<int> tmul, tadd;
+    struct Cell {
+        T mul, add;
+    };
+    vector<Cell> t;
     int n;
 
-    FenwickTree(int _n): tmul (_n + 1), tadd (_n + 1), n (_n) {
+    FenwickTree(int _n): t (_n + 1), n (_n) {
     }
 
-    void update_point(int x, int mul, int add) {
+    // O(n) build, position i + 1 starts with value a[i]
+    FenwickTree(const vector<T> &a): t (a.size() + 1), n (a.size()) {
+        for (int i = 1; i <= n; ++i) t[i].add = a[i - 1];
+        build();
+    }
+
+    // turns raw per-position coefficients into tree sums in O(n)
+    void build() {
+        for (int x = 1; x <= n; ++x) {
+            int y = x + (x & (-x));
+            if (y <= n) {
+                t[y].mul += t[x].mul;
+                t[y].add += t[x].add;
+            }
+        }
+    }
+
+    // inverse of build()
+    void unbuild() {
+        for (int x = n; x >= 1; --x) {
+            int y = x + (x & (-x));
+            if (y <= n) {
+                t[y].mul -= t[x].mul;
+                t[y].add -= t[x].add;
+            }
+        }
+    }
+
+    void update_point(int x, T mul, T add) {
         while (1<=x && x<=n) {
-            tmul[x]+=mul;
-            tadd[x]+=add;
+            Cell &c = t[x];
+            c.mul+=mul;
+            c.add+=add;
             x+=x&(-x);
         }
     }
 
-    void update_range(int l, int r, int val) { // l to r (inclusive)
+    void update_range(int l, int r, T val) { // l to r (inclusive)
         update_point(l,val,-val*(l-1));
         update_point(r,-val,val*r);
     }
 
-    int get(int x) {
-        int mul = 0, add = 0, fst = x;
+    // batch of (l, r, val): one pass over the raw arrays when that is cheaper
+    void update_range(const vector<tuple<int, int, T>> &ups) {
+        if ((long long) ups.size() * __lg(n + 1) < n) {
+            for (auto &[l, r, val] : ups) update_range(l, r, val);
+            return;
+        }
+        unbuild();
+        for (auto &[l, r, val] : ups) { // same bounds as update_point
+            if (1<=l && l<=n) t[l].mul+=val, t[l].add-=val*(l-1);
+            if (1<=r && r<=n) t[r].mul-=val, t[r].add+=val*r;
+        }
+        build();
+    }
+
+    T get(int x) {
+        T mul = 0, add = 0;
+        int fst = x;
         while (1<=x && x<=n) {
-            mul+=tmul[x];
-            add+=tadd[x];
+            const Cell &c = t[x];
+            mul+=c.mul;
+            add+=c.add;
             x=x&(x-1);
         }
         return (mul*fst+add);
     }
 
-    int value(int x) {
+    // batch of get(x): all prefixes in O(n) when that is cheaper
+    vector<T> get(const vector<int> &xs) {
+        vector<T> res(xs.size());
+        if ((long long) xs.size() * __lg(n + 1) < n) {
+            for (int i = 0; i < (int) xs.size(); ++i) res[i] = get(xs[i]);
+            return res;
+        }
+        vector<T> pmul(n + 1), padd(n + 1);
+        for (int x = 1; x <= n; ++x) {
+            pmul[x] = pmul[x & (x - 1)] + t[x].mul;
+            padd[x] = padd[x & (x - 1)] + t[x].add;
+        }
+        for (int i = 0; i < (int) xs.size(); ++i) {
+            int x = xs[i];
+            if (1 <= x && x <= n) res[i] = pmul[x] * x + padd[x];
+        }
+        return res;
+    }
+
+    T value(int x) {
         return (get(x)-get(x-1));
     }
-};
 
+    // smallest x with get(x) >= prefix, n + 1 if none (values must be >= 0)
+    int lower_bound(T prefix) {
+        int x = 0;
+        T mul = 0, add = 0;
+        for (int pw = 1 << __lg(n + 1); pw; pw >>= 1) {
+            int y = x + pw;
+            if (y > n) continue;
+            const Cell &c = t[y];
+            if ((mul + c.mul) * y + add + c.add < prefix) {
+                x = y;
+                mul += c.mul;
+                add += c.add;
+            }
+        }
+        return x + 1;
+    }
+};
@@ -0,0 +1,101 @@
+// Offline 2D range add / range sum on sparse coordinates (up to 1e9)
+// Same mul/add trick as FenwickTree, one dimension up: a rectangle add puts
+// +-val on 4 corners of a difference grid d, and the prefix sum
+//   S(X, Y) = sum d[i][j] * (X + 1 - i) * (Y + 1 - j)
+// is read back from 4 coefficient sums: d, d*i, d*j, d*i*j.
+// Register every update rectangle with add_rect() before build(); queries
+// need no registration. Each outer node keeps a compressed inner tree over
+// the y's that reach it, all packed in one array (CSR).
+// Space: O(Q log Q), Time: O(log^2 Q) per update / query
+// T must hold the corner sums of val * x * y. The __int128 default is safe
+// for |val| and coordinates up to 1e9 over up to 1e10 updates; long long
+// only when max|x| * max|y| * sum|val| stays below 9e18.
+
+template<typename T = __int128>
+struct FenwickTree2D {
+    struct Cell {
+        T d, di, dj, dij;
+    };
+    vector<pair<long long, long long>> pts; // registered corners
+    vector<long long> xs, ys;
+    vector<int> start; // inner tree of outer node i is ys/t[start[i], start[i+1])
+    vector<Cell> t;
+    int m;
+
+    void add_rect(long long x1, long long y1, long long x2, long long y2) {
+        pts.push_back({x1, y1});
+        pts.push_back({x1, y2 + 1});
+        pts.push_back({x2 + 1, y1});
+        pts.push_back({x2 + 1, y2 + 1});
+    }
+
+    void build() {
+        for (auto &p : pts) xs.push_back(p.first);
+        sort(xs.begin(), xs.end());
+        xs.erase(unique(xs.begin(), xs.end()), xs.end());
+        m = xs.size();
+        vector<pair<int, long long>> all;
+        for (auto &p : pts) {
+            int i = lower_bound(xs.begin(), xs.end(), p.first) - xs.begin() + 1;
+            for (; i <= m; i += i & (-i)) all.push_back({i, p.second});
+        }
+        sort(all.begin(), all.end());
+        all.erase(unique(all.begin(), all.end()), all.end());
+        start.assign(m + 2, 0);
+        for (auto &p : all) start[p.first + 1]++;
+        for (int i = 1; i <= m + 1; ++i) start[i] += start[i - 1];
+        ys.resize(all.size());
+        for (int k = 0; k < (int) all.size(); ++k) ys[k] = all[k].second;
+        t.assign(all.size(), Cell());
+        vector<pair<long long, long long>>().swap(pts);
+    }
+
+    // (x, y) must be a registered corner
+    void update_point(long long x, long long y, T val) {
+        int i = lower_bound(xs.begin(), xs.end(), x) - xs.begin() + 1;
+        T vx = val * x, vy = val * y, vxy = vx * y;
+        for (; i <= m; i += i & (-i)) {
+            int b = start[i], len = start[i + 1] - b;
+            int j = lower_bound(ys.begin() + b, ys.begin() + b + len, y) - ys.begin() - b + 1;
+            for (; j <= len; j += j & (-j)) {
+                Cell &c = t[b + j - 1];
+                c.d += val; c.di += vx; c.dj += vy; c.dij += vxy;
+            }
+        }
+    }
+
+    // sum over x <= X, y <= Y
+    T prefix(long long X, long long Y) {
+        T d = 0, di = 0, dj = 0, dij = 0;
+        int i = upper_bound(xs.begin(), xs.end(), X) - xs.begin();
+        for (; i > 0; i &= i - 1) {
+            int b = start[i], len = start[i + 1] - b;
+            int j = upper_bound(ys.begin() + b, ys.begin() + b + len, Y) - ys.begin() - b;
+            for (; j > 0; j &= j - 1) {
+                const Cell &c = t[b + j - 1];
+                d += c.d; di += c.di; dj += c.dj; dij += c.dij;
+            }
+        }
+        return d * (X + 1) * (Y + 1) - di * (Y + 1) - dj * (X + 1) + dij;
+    }
+
+    // add val to every cell of [x1, x2] x [y1, y2] (inclusive, registered)
+    void update(long long x1, long long y1, long long x2, long long y2, T val) {
+        update_point(x1, y1, val);
+        update_point(x1, y2 + 1, -val);
+        update_point(x2 + 1, y1, -val);
+        update_point(x2 + 1, y2 + 1, val);
+    }
+
+    // sum over [x1, x2] x [y1, y2] (inclusive)
+    T query(long long x1, long long y1, long long x2, long long y2) {
+        return prefix(x2, y2) - prefix(x1 - 1, y2) - prefix(x2, y1 - 1) + prefix(x1 - 1, y1 - 1);
+    }
+};
+
+// Example usage:
+// FenwickTree2D<> ft;
+// for (auto &u : updates) ft.add_rect(u.x1, u.y1, u.x2, u.y2);
+// ft.build();
+// then, in the original order: ft.update(x1, y1, x2, y2, val) / ft.query(x1, y1, x2, y2)
+// (cast the __int128 result to long long to print it once it is known to fit)
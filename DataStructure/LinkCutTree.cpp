@@ -0,0 +1,149 @@
+// Link-cut tree (dynamic forest). Standalone: the node helpers (applyReverse,
+// pushDown, update, setLink, getDir, rotate, splay) are a copy of the ones in
+// SplayTree.cpp, changed where a splay tree ends. Here that is where the
+// parent does not list the node as a child (the parent pointer is then the
+// path-parent of a preferred path), so rotate keeps that pointer and splay
+// pushes tags down from the splay root first. Fixes to the shared helpers
+// must be made in both files. Vertices are 0-indexed, each carries a value.
+// Time: O(log n) amortized per operation
+struct LinkCutTree {
+    struct Node {
+        int child[2], parent;
+        bool reverse;
+        long long value, sum;
+    };
+
+    vector<Node> t;
+    vector<int> stk;
+
+    LinkCutTree(int n) : t(n + 1) {}
+
+    bool isRoot(int x) { // root of its splay tree
+        int p = t[x].parent;
+        return p == 0 || (t[p].child[0] != x && t[p].child[1] != x);
+    }
+
+    // a flagged node already has its own children swapped
+    void applyReverse(int x) {
+        if (x == 0) return;
+        swap(t[x].child[0], t[x].child[1]);
+        t[x].reverse = !t[x].reverse;
+    }
+
+    void pushDown(int x) {
+        if (t[x].reverse) {
+            applyReverse(t[x].child[0]);
+            applyReverse(t[x].child[1]);
+            t[x].reverse = false;
+        }
+    }
+
+    void update(int x) {
+        t[x].sum = t[t[x].child[0]].sum + t[t[x].child[1]].sum + t[x].value;
+    }
+
+    void setLink(int x, int y, int d) {
+        t[x].child[d] = y;
+        t[y].parent = x;
+    }
+
+    int getDir(int x, int y) {
+        return t[x].child[0] == y ? 0 : 1;
+    }
+
+    void rotate(int x, int d) {
+        int y = t[x].child[d], z = t[x].parent;
+        setLink(x, t[y].child[d ^ 1], d);
+        setLink(y, x, d ^ 1);
+        if (t[z].child[0] == x) t[z].child[0] = y;
+        else if (t[z].child[1] == x) t[z].child[1] = y;
+        t[y].parent = z; // keeps the path-parent when x was a splay root
+        update(x); update(y);
+    }
+
+    void splay(int x) {
+        // no top-down walk here, so push tags from the splay root first
+        stk.push_back(x);
+        for (int y = x; !isRoot(y); y = t[y].parent) stk.push_back(t[y].parent);
+        while (!stk.empty()) pushDown(stk.back()), stk.pop_back();
+        while (!isRoot(x)) {
+            int y = t[x].parent, z = t[y].parent;
+            int dy = getDir(y, x);
+            if (isRoot(y)) rotate(y, dy);
+            else {
+                int dz = getDir(z, y);
+                if (dy == dz) rotate(z, dz), rotate(y, dy);
+                else rotate(y, dy), rotate(z, dz);
+            }
+        }
+    }
+
+    // make root..x the preferred path, x ends up at the top of its splay tree
+    void access(int x) {
+        for (int y = x, last = 0; y; last = y, y = t[y].parent) {
+            splay(y);
+            t[y].child[1] = last;
+            update(y);
+        }
+        splay(x);
+    }
+
+    void makeRoot(int x) {
+        access(x);
+        applyReverse(x);
+    }
+
+    int findRoot(int x) {
+        access(x);
+        while (pushDown(x), t[x].child[0]) x = t[x].child[0];
+        splay(x);
+        return x;
+    }
+
+    // public interface, vertices 0..n-1
+
+    void evert(int u) { // make u the root of its tree
+        makeRoot(u + 1);
+    }
+
+    bool connected(int u, int v) {
+        return findRoot(u + 1) == findRoot(v + 1);
+    }
+
+    bool link(int u, int v) { // false if already connected
+        ++u, ++v;
+        makeRoot(u);
+        if (findRoot(v) == u) return false;
+        t[u].parent = v;
+        return true;
+    }
+
+    bool cut(int u, int v) { // false if there is no edge u-v
+        ++u, ++v;
+        makeRoot(u);
+        access(v);
+        pushDown(u);
+        if (t[v].child[0] != u || t[u].child[1] != 0) return false;
+        t[v].child[0] = t[u].parent = 0;
+        update(v);
+        return true;
+    }
+
+    void setValue(int u, long long value) {
+        access(++u);
+        t[u].value = value;
+        update(u);
+    }
+
+    // sum of values on the path u..v (u and v must be connected)
+    long long path_aggregate(int u, int v) {
+        makeRoot(u + 1);
+        access(v + 1);
+        return t[v + 1].sum;
+    }
+};
+
+// Example usage:
+// LinkCutTree lct(n);
+// lct.setValue(u, w); lct.link(u, v); lct.cut(u, v);
+// if (lct.connected(u, v)) total = lct.path_aggregate(u, v);
@@ -2,83 +2,177 @@
 // Supports point update and range query with version control
 // Space: O(N + Q*log(N)) where Q is number of updates
 // Time: O(log(N)) per operation
+// Nodes sit in fixed-size chunks that never move, so a growing history is
+// never copied. release(version) recycles the nodes only that version was
+// using; the reference counts it needs live in a side array that is built on
+// the first release, so trees that never release keep 12-byte int nodes.
 
-struct PersistentSegmentTree {
-    struct Node {
-        int val;
-        int left, right;
-        Node() : val(0), left(-1), right(-1) {}
-        Node(int v, int l, int r) : val(v), left(l), right(r) {}
-    };
-    
-    vector<Node> tree;
+// Chunked node arena: indices stay valid forever, freed slots are reused
+template<typename Node, int LOG_CHUNK = 16>
+struct NodePool {
+    static const int CHUNK = 1 << LOG_CHUNK;
+    vector<unique_ptr<Node[]>> chunks;
+    vector<int> freed;
+    int used = 0;
+
+    Node &operator[](int i) {
+        return chunks[i >> LOG_CHUNK][i & (CHUNK - 1)];
+    }
+
+    int alloc() {
+        if (!freed.empty()) {
+            int i = freed.back();
+            freed.pop_back();
+            return i;
+        }
+        if (used == (int) chunks.size() * CHUNK) chunks.emplace_back(new Node[CHUNK]);
+        return used++;
+    }
+
+    void release(int i) {
+        freed.push_back(i);
+    }
+
+    int size() const { // live nodes
+        return used - freed.size();
+    }
+};
+
+// Version roots over a NodePool, shared by the persistent trees below.
+// Node needs left and right (-1 for a leaf).
+template<typename Node>
+struct PersistentVersions {
+    NodePool<Node> tree;
     vector<int> roots;
+    int latest = -1; // newest root, kept alive for updates even if released
+    vector<unsigned> ref; // parents and roots pointing at a node, empty until release()
+    
+    int make(const Node &nd) {
+        int node = tree.alloc();
+        tree[node] = nd;
+        if (!ref.empty()) {
+            if (node >= (int) ref.size()) ref.resize(tree.used);
+            ref[node] = 0;
+            if (nd.left != -1) ref[nd.left]++, ref[nd.right]++;
+        }
+        return node;
+    }
+    
+    // One more reference to node, counting its subtree on the first visit
+    void count(int node) {
+        if (node != -1 && ref[node]++ == 0) count(tree[node].left), count(tree[node].right);
+    }
+    
+    // Drop one reference, recycling whatever becomes unreachable
+    void unref(int node) {
+        if (node == -1 || --ref[node]) return;
+        unref(tree[node].left);
+        unref(tree[node].right);
+        tree.release(node);
+    }
+    
+    void add_root(int node) {
+        if (!ref.empty()) ref[node] += 2, unref(latest);
+        roots.push_back(latest = node);
+    }
+    
+    // Free the nodes only this version uses. A released version must not be
+    // queried again; releasing the newest one still lets updates build on it.
+    void release(int version) {
+        if (ref.empty()) {
+            ref.assign(tree.used, 0);
+            count(latest);
+            for (int root : roots) count(root);
+        }
+        unref(roots[version]);
+        roots[version] = -1;
+    }
+    
+    int version_count() {
+        return roots.size();
+    }
+};
+
+template<typename T>
+struct SumNode {
+    T val;
+    int left, right;
+};
+
+template<typename T = int>
+struct PersistentSegmentTree : PersistentVersions<SumNode<T>> {
+    typedef SumNode<T> Node;
+    typedef PersistentVersions<Node> Base;
+    using Base::tree;
+    using Base::roots;
+    using Base::latest;
+    using Base::make;
+    using Base::add_root;
     int n;
     
     PersistentSegmentTree(int _n) : n(_n) {
-        tree.reserve(2 * n + 1000000); // Reserve space for nodes
-        roots.push_back(build(0, n - 1));
+        add_root(build(0, n - 1));
+    }
+    
+    PersistentSegmentTree(vector<T> &a) : n(a.size()) {
+        add_root(build(a, 0, n - 1));
     }
     
-    PersistentSegmentTree(vector<int> &a) : n(a.size()) {
-        tree.reserve(2 * n + 1000000);
-        roots.push_back(build(a, 0, n - 1));
+    int make(T val, int l, int r) {
+        return make(Node {val, l, r});
     }
     
     int build(int l, int r) {
-        int node = tree.size();
-        tree.push_back(Node());
-        if (l == r) {
-            tree[node].val = 0;
-        } else {
-            int mid = (l + r) / 2;
-            tree[node].left = build(l, mid);
-            tree[node].right = build(mid + 1, r);
-            tree[node].val = tree[tree[node].left].val + tree[tree[node].right].val;
-        }
-        return node;
+        if (l == r) return make(0, -1, -1);
+        int mid = (l + r) / 2;
+        int left = build(l, mid), right = build(mid + 1, r);
+        return make(tree[left].val + tree[right].val, left, right);
     }
     
-    int build(vector<int> &a, int l, int r) {
-        int node = tree.size();
-        tree.push_back(Node());
-        if (l == r) {
-            tree[node].val = a[l];
-        } else {
-            int mid = (l + r) / 2;
-            tree[node].left = build(a, l, mid);
-            tree[node].right = build(a, mid + 1, r);
-            tree[node].val = tree[tree[node].left].val + tree[tree[node].right].val;
-        }
-        return node;
+    int build(vector<T> &a, int l, int r) {
+        if (l == r) return make(a[l], -1, -1);
+        int mid = (l + r) / 2;
+        int left = build(a, l, mid), right = build(a, mid + 1, r);
+        return make(tree[left].val + tree[right].val, left, right);
     }
     
     // Update position pos to value val, creates new version
-    int update(int node, int l, int r, int pos, int val) {
-        int new_node = tree.size();
-        tree.push_back(tree[node]); // Copy current node
-        
-        if (l == r) {
-            tree[new_node].val = val;
+    int update(int node, int l, int r, int pos, T val) {
+        if (l == r) return make(val, -1, -1);
+        int mid = (l + r) / 2, left = tree[node].left, right = tree[node].right;
+        if (pos <= mid) {
+            left = update(left, l, mid, pos, val);
         } else {
-            int mid = (l + r) / 2;
-            if (pos <= mid) {
-                tree[new_node].left = update(tree[node].left, l, mid, pos, val);
-            } else {
-                tree[new_node].right = update(tree[node].right, mid + 1, r, pos, val);
-            }
-            tree[new_node].val = tree[tree[new_node].left].val + tree[tree[new_node].right].val;
+            right = update(right, mid + 1, r, pos, val);
         }
-        return new_node;
+        return make(tree[left].val + tree[right].val, left, right);
+    }
+    
+    void update(int pos, T val) {
+        add_root(update(latest, 0, n - 1, pos, val));
+    }
+    
+    // Apply many assignments as a single version: positions are sorted and
+    // every node on the union of their paths is created once (last one wins)
+    int batch_update(int node, int l, int r, vector<pair<int, T>> &ups, int lo, int hi) {
+        if (lo == hi) return node;
+        if (l == r) return make(ups[hi - 1].second, -1, -1);
+        int mid = (l + r) / 2;
+        int sp = partition_point(ups.begin() + lo, ups.begin() + hi,
+                                 [&](const pair<int, T> &u) { return u.first <= mid; }) - ups.begin();
+        int left = batch_update(tree[node].left, l, mid, ups, lo, sp);
+        int right = batch_update(tree[node].right, mid + 1, r, ups, sp, hi);
+        return make(tree[left].val + tree[right].val, left, right);
     }
     
-    void update(int pos, int val) {
-        int new_root = update(roots.back(), 0, n - 1, pos, val);
-        roots.push_back(new_root);
+    void batch_update(vector<pair<int, T>> ups) {
+        stable_sort(ups.begin(), ups.end(),
+                    [](const pair<int, T> &a, const pair<int, T> &b) { return a.first < b.first; });
+        add_root(batch_update(latest, 0, n - 1, ups, 0, ups.size()));
     }
     
     // Query sum in range [ql, qr] for specific version
-    int query(int node, int l, int r, int ql, int qr) {
+    T query(int node, int l, int r, int ql, int qr) {
         if (node == -1 || qr < l || r < ql) return 0;
         if (ql <= l && r <= qr) return tree[node].val;
         
@@ -87,54 +181,129 @@ struct PersistentSegmentTree {
                query(tree[node].right, mid + 1, r, ql, qr);
     }
     
-    int query(int version, int ql, int qr) {
+    T query(int version, int ql, int qr) {
         return query(roots[version], 0, n - 1, ql, qr);
     }
     
     // Get value at position pos for specific version
-    int get(int node, int l, int r, int pos) {
+    T get(int node, int l, int r, int pos) {
         if (l == r) return tree[node].val;
         int mid = (l + r) / 2;
         if (pos <= mid) return get(tree[node].left, l, mid, pos);
         else return get(tree[node].right, mid + 1, r, pos);
     }
     
-    int get(int version, int pos) {
+    T get(int version, int pos) {
         return get(roots[version], 0, n - 1, pos);
     }
+};
+
+template<typename T>
+struct TagNode {
+    T val, tag;
+    int left, right;
+};
+
+// Persistent range add / range sum with permanent (non-propagating) tags
+// A tag stays on the node it was put on and is never pushed down, so old
+// versions keep sharing children. val already includes the tags at and below
+// the node; queries add the tags of the ancestors on the way down.
+// Space: O(N + Q*log(N)), Time: O(log(N)) per operation
+template<typename T = long long>
+struct PersistentLazySegmentTree : PersistentVersions<TagNode<T>> {
+    typedef TagNode<T> Node;
+    typedef PersistentVersions<Node> Base;
+    using Base::tree;
+    using Base::roots;
+    using Base::latest;
+    using Base::make;
+    using Base::add_root;
+    int n;
     
-    int version_count() {
-        return roots.size();
+    PersistentLazySegmentTree(vector<T> &a) : n(a.size()) {
+        add_root(build(a, 0, n - 1));
+    }
+    
+    int make(T val, T tag, int l, int r) {
+        return make(Node {val, tag, l, r});
+    }
+    
+    int build(vector<T> &a, int l, int r) {
+        if (l == r) return make(a[l], 0, -1, -1);
+        int mid = (l + r) / 2;
+        int left = build(a, l, mid), right = build(a, mid + 1, r);
+        return make(tree[left].val + tree[right].val, 0, left, right);
+    }
+    
+    // Add val on [ql, qr]: O(log(N)) new nodes, untouched subtrees are shared
+    int range_add(int node, int l, int r, int ql, int qr, T val) {
+        if (qr < l || r < ql) return node;
+        Node cur = tree[node];
+        if (ql <= l && r <= qr) {
+            return make(cur.val + val * (r - l + 1), cur.tag + val, cur.left, cur.right);
+        }
+        int mid = (l + r) / 2;
+        int left = range_add(cur.left, l, mid, ql, qr, val);
+        int right = range_add(cur.right, mid + 1, r, ql, qr, val);
+        return make(tree[left].val + tree[right].val + cur.tag * (r - l + 1), cur.tag, left, right);
+    }
+    
+    void range_add(int ql, int qr, T val) {
+        add_root(range_add(latest, 0, n - 1, ql, qr, val));
+    }
+    
+    // acc is the sum of the tags above node
+    T query(int node, int l, int r, int ql, int qr, T acc) {
+        if (qr < l || r < ql) return 0;
+        if (ql <= l && r <= qr) return tree[node].val + acc * (r - l + 1);
+        int mid = (l + r) / 2;
+        acc += tree[node].tag;
+        return query(tree[node].left, l, mid, ql, qr, acc) +
+               query(tree[node].right, mid + 1, r, ql, qr, acc);
+    }
+    
+    // Query sum in range [ql, qr] for specific version
+    T query(int version, int ql, int qr) {
+        return query(roots[version], 0, n - 1, ql, qr, 0);
+    }
+    
+    T get(int version, int pos) {
+        return query(version, pos, pos);
     }
 };
 
 // Example usage for k-th smallest in range [l, r]:
-// Build PST on sorted positions
-// For each element, update its position in sorted order
-// Query difference between version[r+1] and version[l]
-// Binary search on answer
+// Build PST over ranks in sorted order
+// Version i marks the ranks of the first i elements
+// Walk version[r+1] minus version[l] down to the k-th marked rank
+// (WaveletMatrix.cpp answers the same query in less memory)
 
 // K-th smallest number in range [l, r] using PST
 struct KthSmallest {
-    PersistentSegmentTree pst;
     int n;
+    vector<int> sorted_vals;
+    PersistentSegmentTree<> pst;
     
-    KthSmallest(vector<int> &a) : n(a.size()), pst(n) {
+    KthSmallest(vector<int> &a) : n(a.size()), sorted_vals(n), pst(n) {
         vector<pair<int, int>> sorted_a;
         for (int i = 0; i < n; ++i) {
             sorted_a.push_back({a[i], i});
         }
         sort(sorted_a.begin(), sorted_a.end());
         
+        vector<int> rank(n);
+        for (int i = 0; i < n; ++i) {
+            sorted_vals[i] = sorted_a[i].first;
+            rank[sorted_a[i].second] = i;
+        }
         for (int i = 0; i < n; ++i) {
-            int pos = sorted_a[i].second;
-            pst.update(pos, 1);
+            pst.update(rank[i], 1);
         }
     }
     
     // Find k-th smallest (1-indexed) in range [l, r]
     int kth_smallest(int l, int r, int k) {
-        return query_kth(pst.roots[0], pst.roots[r - l + 1], 0, n - 1, k);
+        return sorted_vals[query_kth(pst.roots[l], pst.roots[r + 1], 0, n - 1, k)];
     }
     
     int query_kth(int node_l, int node_r, int l, int r, int k) {
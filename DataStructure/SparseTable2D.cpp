@@ -1,81 +1,128 @@
 // 2D Sparse Table for Range Minimum/Maximum Query
-// Preprocessing: O(N*M*log(N)*log(M))
+// Preprocessing: O(N*M*log(N)*log(M)), rows of a level split over threads
+// that are started once per build and step through the levels together
 // Query: O(1)
+// All levels live in one flat buffer: level (k1, k2) is an n x m grid
+// starting at (k1 * log_m + k2) * n * m. Combine must be idempotent
+// (min, max, gcd, and, or) because query ranges overlap.
 
 template<typename T>
+struct MinCombine {
+    T operator()(const T &a, const T &b) const { return min(a, b); }
+};
+
+template<typename T>
+struct MaxCombine {
+    T operator()(const T &a, const T &b) const { return max(a, b); }
+};
+
+template<typename T, typename Combine = MinCombine<T>>
 struct SparseTable2D {
-    vector<vector<vector<vector<T>>>> st;
-    vector<int> log_table;
-    int n, m;
-    
-    // Function to combine two values (min, max, gcd, etc.)
+    vector<T> st;
+    int n, m, log_n, log_m;
+    Combine comb;
+
     T combine(T a, T b) {
-        return min(a, b); // Change to max(a, b) for RMQ
+        return comb(a, b);
     }
-    
-    void build_log(int maxn) {
-        log_table.resize(maxn + 1);
-        log_table[1] = 0;
-        for (int i = 2; i <= maxn; ++i) {
-            log_table[i] = log_table[i / 2] + 1;
+
+    static int lg(int x) {
+        return 31 - __builtin_clz(x);
+    }
+
+    T *level(int k1, int k2) {
+        return st.data() + (size_t) (k1 * log_m + k2) * n * m;
+    }
+
+    // dst[j] = combine(x[j], y[j]) over a contiguous run; branch-free and
+    // unaliased, so it is vectorized even at -O2 for min/max of numbers
+    __attribute__((optimize("tree-vectorize")))
+    void combine_run(T *__restrict dst, const T *__restrict x, const T *__restrict y, size_t len) {
+        for (size_t j = 0; j < len; ++j) dst[j] = comb(x[j], y[j]);
+    }
+
+    // one level: row i of dst combines rows i and i + off of src
+    struct Step {
+        T *dst, *src;
+        size_t off;
+        int rows, len;
+    };
+
+    // runs the steps in order; with threads, each one takes a contiguous
+    // block of rows of every step and waits for the others in between
+    void run(const vector<Step> &plan, int threads) {
+        auto rows = [&](const Step &s, int lo, int hi) {
+            for (int i = lo; i < hi; ++i) {
+                size_t row = (size_t) i * m;
+                combine_run(s.dst + row, s.src + row, s.src + row + s.off, s.len);
+            }
+        };
+        if (threads <= 1 || (long long) n * m < (1 << 16)) {
+            for (const Step &s : plan) rows(s, 0, s.rows);
+            return;
         }
+        mutex mtx;
+        condition_variable cv;
+        int arrived = 0, round = 0;
+        auto worker = [&](int t) {
+            for (const Step &s : plan) {
+                int step = (s.rows + threads - 1) / threads;
+                rows(s, min(s.rows, t * step), min(s.rows, (t + 1) * step));
+                unique_lock<mutex> lock(mtx);
+                int r = round;
+                if (++arrived == threads) arrived = 0, ++round, cv.notify_all();
+                else cv.wait(lock, [&] { return round != r; });
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+        worker(0);
+        for (auto &t : pool) t.join();
     }
-    
-    SparseTable2D(vector<vector<T>> &a) {
+
+    SparseTable2D(vector<vector<T>> &a, int threads = thread::hardware_concurrency()) {
         n = a.size();
         m = a[0].size();
-        
-        build_log(max(n, m));
-        
-        int log_n = log_table[n] + 1;
-        int log_m = log_table[m] + 1;
-        
-        st.assign(log_n, vector<vector<vector<T>>>(log_m, 
-                  vector<vector<T>>(n, vector<T>(m))));
-        
+        log_n = lg(n) + 1;
+        log_m = lg(m) + 1;
+        st.resize((size_t) log_n * log_m * n * m);
+
         // Copy original array
+        T *base = level(0, 0);
         for (int i = 0; i < n; ++i) {
-            for (int j = 0; j < m; ++j) {
-                st[0][0][i][j] = a[i][j];
-            }
+            copy(a[i].begin(), a[i].end(), base + (size_t) i * m);
         }
-        
+
+        vector<Step> plan;
         // Build for rows (k1 varies, k2 = 0)
         for (int k1 = 1; k1 < log_n; ++k1) {
-            for (int i = 0; i + (1 << k1) <= n; ++i) {
-                for (int j = 0; j < m; ++j) {
-                    st[k1][0][i][j] = combine(st[k1-1][0][i][j], 
-                                              st[k1-1][0][i + (1 << (k1-1))][j]);
-                }
-            }
+            plan.push_back({level(k1, 0), level(k1 - 1, 0), (size_t) (1 << (k1 - 1)) * m,
+                            n - (1 << k1) + 1, m});
         }
-        
         // Build for columns (k1 varies, k2 varies)
         for (int k1 = 0; k1 < log_n; ++k1) {
             for (int k2 = 1; k2 < log_m; ++k2) {
-                for (int i = 0; i + (1 << k1) <= n; ++i) {
-                    for (int j = 0; j + (1 << k2) <= m; ++j) {
-                        st[k1][k2][i][j] = combine(st[k1][k2-1][i][j], 
-                                                   st[k1][k2-1][i][j + (1 << (k2-1))]);
-                    }
-                }
+                plan.push_back({level(k1, k2), level(k1, k2 - 1), (size_t) 1 << (k2 - 1),
+                                n - (1 << k1) + 1, m - (1 << k2) + 1});
             }
         }
+        run(plan, threads);
     }
-    
+
     // Query rectangle [r1, r2] x [c1, c2] (0-indexed, inclusive)
     T query(int r1, int c1, int r2, int c2) {
-        int k1 = log_table[r2 - r1 + 1];
-        int k2 = log_table[c2 - c1 + 1];
-        
-        int len1 = 1 << k1;
-        int len2 = 1 << k2;
-        
-        T res = st[k1][k2][r1][c1];
-        res = combine(res, st[k1][k2][r2 - len1 + 1][c1]);
-        res = combine(res, st[k1][k2][r1][c2 - len2 + 1]);
-        res = combine(res, st[k1][k2][r2 - len1 + 1][c2 - len2 + 1]);
-        
+        int k1 = lg(r2 - r1 + 1);
+        int k2 = lg(c2 - c1 + 1);
+
+        const T *s = level(k1, k2);
+        size_t top = (size_t) r1 * m, bottom = (size_t) (r2 - (1 << k1) + 1) * m;
+        int right = c2 - (1 << k2) + 1;
+
+        T res = s[top + c1];
+        res = combine(res, s[bottom + c1]);
+        res = combine(res, s[top + right]);
+        res = combine(res, s[bottom + right]);
+
         return res;
     }
 };
@@ -83,6 +130,6 @@ struct SparseTable2D {
 // Example usage:
 // vector<vector<int>> a(n, vector<int>(m));
 // // Fill array a
-// SparseTable2D<int> st(a);
+// SparseTable2D<int> st(a);                      // min
+// SparseTable2D<int, MaxCombine<int>> st_max(a); // max
 // int result = st.query(r1, c1, r2, c2);
-
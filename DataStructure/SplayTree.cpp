@@ -1,84 +1,200 @@
-struct Node {
-    Node * child[2], * parent;
-    bool reverse;
-    int value, size;
-    long long sum;
+// Implicit splay tree over a sequence, any number of independent trees.
+// Nodes are 32-bit indices into the tree's own pool (0 is nil) and erased
+// nodes are reused, so nothing leaks and a tree stays compact in memory.
+// Lazy tags: reverse, range add, range assign; aggregate: sum.
+// Time: O(log n) amortized per operation, O(n) build
+struct SplayTree {
+    struct Node {
+        int child[2], parent;
+        int size, value;
+        int tagAdd, tagSet;
+        bool reverse, hasSet;
+        long long sum;
+    };
+
+    vector<Node> t;
+    vector<int> freed;
+    int root;
+
+    SplayTree() : t(1), root(0) {}
+
+    SplayTree(const vector<int> &a) : t(1), root(0) {
+        t.reserve(a.size() + 1);
+        root = build(a, 0, a.size());
+    }
+
+    int newNode(int value) {
+        int x;
+        if (!freed.empty()) x = freed.back(), freed.pop_back();
+        else x = t.size(), t.emplace_back();
+        t[x] = Node();
+        t[x].size = 1;
+        t[x].value = value;
+        t[x].sum = value;
+        return x;
+    }
+
+    // balanced tree over a[l, r)
+    int build(const vector<int> &a, int l, int r) {
+        if (l >= r) return 0;
+        int mid = (l + r) / 2, x = newNode(a[mid]);
+        setLink(x, build(a, l, mid), 0);
+        setLink(x, build(a, mid + 1, r), 1);
+        update(x);
+        return x;
+    }
+
+    // a flagged node already has its own children swapped
+    void applyReverse(int x) {
+        if (x == 0) return;
+        swap(t[x].child[0], t[x].child[1]);
+        t[x].reverse = !t[x].reverse;
+    }
+
+    void applySet(int x, int v) {
+        if (x == 0) return;
+        t[x].value = v;
+        t[x].sum = (long long) v * t[x].size;
+        t[x].tagSet = v;
+        t[x].hasSet = true;
+        t[x].tagAdd = 0;
+    }
+
+    void applyAdd(int x, int v) {
+        if (x == 0) return;
+        t[x].value += v;
+        t[x].sum += (long long) v * t[x].size;
+        if (t[x].hasSet) t[x].tagSet += v;
+        else t[x].tagAdd += v;
+    }
+
+    void pushDown(int x) {
+        if (x == 0) return;
+        Node &n = t[x];
+        if (n.reverse) {
+            applyReverse(n.child[0]);
+            applyReverse(n.child[1]);
+            n.reverse = false;
+        }
+        if (n.hasSet) {
+            applySet(n.child[0], n.tagSet);
+            applySet(n.child[1], n.tagSet);
+            n.hasSet = false;
+        }
+        if (n.tagAdd) {
+            applyAdd(n.child[0], n.tagAdd);
+            applyAdd(n.child[1], n.tagAdd);
+            n.tagAdd = 0;
+        }
+    }
+
+    void update(int x) {
+        Node &n = t[x];
+        n.size = t[n.child[0]].size + t[n.child[1]].size + 1;
+        n.sum = t[n.child[0]].sum + t[n.child[1]].sum + n.value;
+    }
+
+    void setLink(int x, int y, int d) {
+        t[x].child[d] = y;
+        t[y].parent = x;
+    }
+
+    int getDir(int x, int y) {
+        return t[x].child[0] == y ? 0 : 1;
+    }
+
+    void rotate(int x, int d) {
+        int y = t[x].child[d], z = t[x].parent;
+        setLink(x, t[y].child[d ^ 1], d);
+        setLink(y, x, d ^ 1);
+        setLink(z, y, getDir(z, x));
+        update(x); update(y);
+    }
+
+    void splay(int x) {
+        while(t[x].parent != 0) {
+            int y = t[x].parent, z = t[y].parent;
+            int dy = getDir(y, x), dz = getDir(z, y);
+            if(z == 0) rotate(y, dy);
+            else if(dy == dz) rotate(z, dz), rotate(y, dy);
+            else rotate(y, dy), rotate(z, dz);
+        }
+    }
+
+    int nodeAt(int x, int pos) {
+        while(pushDown(x), t[t[x].child[0]].size != pos)
+            if(pos < t[t[x].child[0]].size) x = t[x].child[0];
+            else pos -= t[t[x].child[0]].size + 1, x = t[x].child[1];
+        return splay(x), x;
+    }
+
+    void split(int x, int left, int &t1, int &t2) {
+        if(left == 0) t1 = 0, t2 = x;
+        else {
+            t1 = nodeAt(x, left - 1);
+            t2 = t[t1].child[1];
+            t[t1].child[1] = t[t2].parent = 0;
+            update(t1);
+        }
+    }
+
+    int join(int x, int y) {
+        if(x == 0) return y;
+        x = nodeAt(x, t[x].size - 1);
+        setLink(x, y, 1);
+        update(x);
+        return x;
+    }
+
+    // cuts out [l, r], runs f on that subtree's root, glues it back
+    template<typename F>
+    void withRange(int l, int r, F f) {
+        int a, b, c;
+        split(root, r + 1, b, c);
+        split(b, l, a, b);
+        f(b);
+        root = join(join(a, b), c);
+    }
+
+    int size() { return t[root].size; }
+
+    void insert(int pos, int value) { // new element gets index pos
+        int a, b;
+        split(root, pos, a, b);
+        root = join(join(a, newNode(value)), b);
+    }
+
+    void erase(int l, int r) {
+        int a, b, c;
+        split(root, r + 1, b, c);
+        split(b, l, a, b);
+        for (vector<int> st {b}; !st.empty(); ) {
+            int x = st.back(); st.pop_back();
+            if (x == 0) continue;
+            st.push_back(t[x].child[0]);
+            st.push_back(t[x].child[1]);
+            freed.push_back(x);
+        }
+        root = join(a, c);
+    }
+
+    int at(int pos) {
+        root = nodeAt(root, pos);
+        return t[root].value;
+    }
+
+    void reverse(int l, int r) { withRange(l, r, [&](int x) { applyReverse(x); }); }
+    void add(int l, int r, int v) { withRange(l, r, [&](int x) { applyAdd(x, v); }); }
+    void assign(int l, int r, int v) { withRange(l, r, [&](int x) { applySet(x, v); }); }
+
+    long long sum(int l, int r) {
+        long long res = 0;
+        withRange(l, r, [&](int x) { res = t[x].sum; });
+        return res;
+    }
 };
 
-Node * nil, * root;
-
-void initTree() {
-    nil = new Node();
-    nil->child[0] = nil->child[1] = nil->parent = nil;
-    nil->value = nil->size = nil->sum = 0;
-    nil->reverse = false;
-    root = nil;
-}
-
-void pushDown(Node * x) {
-    if(x == nil) return;
-    if(x->reverse) {
-        swap(x->child[0], x->child[1]);
-        x->child[0]->reverse = !x->child[0]->reverse;
-        x->child[1]->reverse = !x->child[1]->reverse;
-        x->reverse = false;
-    }
-}
-
-void update(Node * x) {
-    pushDown(x->child[0]); pushDown(x->child[1]);
-    x->size = x->child[0]->size + x->child[1]->size + 1;
-    x->sum = x->child[0]->sum + x->child[1]->sum + x->value;
-}
-
-void setLink(Node * x, Node * y, int d) {
-    x->child[d] = y;
-    y->parent = x;
-}
-
-int getDir(Node * x, Node * y) {
-    return x->child[0] == y ? 0 : 1;
-}
-
-void rotate(Node * x, int d) {
-    Node * y = x->child[d], * z = x->parent;
-    setLink(x, y->child[d ^ 1], d);
-    setLink(y, x, d ^ 1);
-    setLink(z, y, getDir(z, x));
-    update(x); update(y);
-}
-
-void splay(Node * x) {
-    while(x->parent != nil) {
-        Node * y = x->parent, * z = y->parent;
-        int dy = getDir(y, x), dz = getDir(z, y);
-        if(z == nil) rotate(y, dy);
-        else if(dy == dz) rotate(z, dz), rotate(y, dy);
-        else rotate(y, dy), rotate(z, dz);
-    }
-}
-
-Node * nodeAt(Node * x, int pos) {
-    while(pushDown(x), x->child[0]->size != pos)
-        if(pos < x->child[0]->size) x = x->child[0];
-        else pos -= x->child[0]->size + 1, x = x->child[1];
-    return splay(x), x;
-}
-
-void split(Node * x, int left, Node * &t1, Node * &t2) {
-    if(left == 0) t1 = nil, t2 = x;
-    else {
-        t1 = nodeAt(x, left - 1);
-        t2 = t1->child[1];
-        t1->child[1] = t2->parent = nil;
-        update(t1);
-    }
-}
-
-Node * join(Node * x, Node * y) {
-    if(x == nil) return y;
-    x = nodeAt(x, x->size - 1);
-    setLink(x, y, 1);
-    update(x);
-    return x;
-}
+// Example usage (0-indexed, inclusive ranges):
+// SplayTree s(a);
+// s.reverse(l, r); s.add(l, r, v); s.assign(l, r, v);
+// long long total = s.sum(l, r);
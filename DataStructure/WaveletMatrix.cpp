@@ -0,0 +1,121 @@
+// Wavelet Matrix for range order statistics
+// Same kth_smallest(l, r, k) as KthSmallest in PersistentSegmentTree.cpp,
+// plus range rank (count_less) and range frequency queries.
+// Values are compressed to ranks [0, sigma); level d stores bit (LOG-1-d)
+// of every rank, stably partitioned (zeros first) by the bits above it.
+// Space: n*log(sigma) bits (+1/8 for rank counts), Time: O(log(sigma)) per query
+
+// Bitvector with O(1) rank: one 32-bit count per 256 bits
+struct BitRank {
+    vector<unsigned long long> bits;
+    vector<int> cnt;
+
+    BitRank(int n = 0) : bits(n / 64 + 1), cnt(n / 256 + 2) {}
+
+    void set(int i) {
+        bits[i >> 6] |= 1ULL << (i & 63);
+    }
+
+    void build() {
+        for (int i = 0; i < (int) bits.size(); ++i) {
+            cnt[(i >> 2) + 1] += __builtin_popcountll(bits[i]);
+        }
+        for (int i = 1; i < (int) cnt.size(); ++i) cnt[i] += cnt[i - 1];
+    }
+
+    // number of ones in [0, i)
+    int rank1(int i) const {
+        int w = i >> 6, res = cnt[i >> 8];
+        for (int j = w & ~3; j < w; ++j) res += __builtin_popcountll(bits[j]);
+        return res + __builtin_popcountll(bits[w] & ((1ULL << (i & 63)) - 1));
+    }
+};
+
+struct WaveletMatrix {
+    int n, LOG;
+    vector<int> vals; // sorted distinct values
+    vector<BitRank> level;
+    vector<int> zeros; // zeros[d]: number of 0 bits on level d
+
+    WaveletMatrix(const vector<int> &a) : n(a.size()), vals(a) {
+        sort(vals.begin(), vals.end());
+        vals.erase(unique(vals.begin(), vals.end()), vals.end());
+        LOG = 1;
+        while ((1 << LOG) < (int) vals.size()) ++LOG;
+        vector<int> cur(n), nxt(n);
+        for (int i = 0; i < n; ++i) {
+            cur[i] = lower_bound(vals.begin(), vals.end(), a[i]) - vals.begin();
+        }
+        level.assign(LOG, BitRank(n));
+        zeros.assign(LOG, 0);
+        for (int d = 0; d < LOG; ++d) {
+            int b = LOG - 1 - d;
+            for (int i = 0; i < n; ++i) {
+                if (cur[i] >> b & 1) level[d].set(i);
+                else nxt[zeros[d]++] = cur[i];
+            }
+            for (int i = 0, k = zeros[d]; i < n; ++i) {
+                if (cur[i] >> b & 1) nxt[k++] = cur[i];
+            }
+            level[d].build();
+            swap(cur, nxt);
+        }
+    }
+
+    // Find k-th smallest (1-indexed) in range [l, r]
+    int kth_smallest(int l, int r, int k) {
+        int lo = l, hi = r + 1, res = 0;
+        --k;
+        for (int d = 0; d < LOG; ++d) {
+            int olo = level[d].rank1(lo), ohi = level[d].rank1(hi);
+            int z = (hi - lo) - (ohi - olo);
+            if (k < z) {
+                lo -= olo; hi -= ohi;
+            } else {
+                k -= z;
+                res |= 1 << (LOG - 1 - d);
+                lo = zeros[d] + olo; hi = zeros[d] + ohi;
+            }
+        }
+        return vals[res];
+    }
+
+    // number of ranks < c in [lo, hi)
+    int count_rank_less(int lo, int hi, int c) {
+        if (c >= (1 << LOG)) return hi - lo;
+        int res = 0;
+        for (int d = 0; d < LOG; ++d) {
+            int olo = level[d].rank1(lo), ohi = level[d].rank1(hi);
+            if (c >> (LOG - 1 - d) & 1) {
+                res += (hi - lo) - (ohi - olo);
+                lo = zeros[d] + olo; hi = zeros[d] + ohi;
+            } else {
+                lo -= olo; hi -= ohi;
+            }
+        }
+        return res;
+    }
+
+    // number of values < x in [l, r]
+    int count_less(int l, int r, int x) {
+        return count_rank_less(l, r + 1, lower_bound(vals.begin(), vals.end(), x) - vals.begin());
+    }
+
+    // number of values in [lo, hi) in [l, r]
+    int range_freq(int l, int r, int lo, int hi) {
+        if (lo >= hi) return 0;
+        return count_less(l, r, hi) - count_less(l, r, lo);
+    }
+
+    // number of occurrences of x in [l, r]
+    int frequency(int l, int r, int x) {
+        int c = lower_bound(vals.begin(), vals.end(), x) - vals.begin();
+        if (c == (int) vals.size() || vals[c] != x) return 0;
+        return count_rank_less(l, r + 1, c + 1) - count_rank_less(l, r + 1, c);
+    }
+};
+
+// Example usage:
+// WaveletMatrix wm(a);
+// wm.kth_smallest(l, r, k); // k-th smallest (1-indexed) in a[l..r]
+// wm.count_less(l, r, x);   // how many a[i] < x for i in [l, r]
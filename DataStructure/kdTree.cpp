@@ -1,170 +1,435 @@
 // -----------------------------------------------------------------
-// A straightforward, but probably sub-optimal KD-tree implmentation
-// that's probably good enough for most things (current it's a
-// 2D-tree)
+// A flat, array-backed KD-tree for K dimensions: kdtree<K, Coord>
 //
-//  - constructs from n points in O(n lg^2 n) time
+//  - builds in place from n points in O(n lg n) time with nth_element,
+//    nodes are stored in one array in preorder, leaves hold buckets
+//    of up to LEAF points
 //  - handles nearest-neighbor query in O(lg n) if points are well
-//    distributed
+//    distributed, plus k-nearest, radius and rectangle queries that
+//    return indices into the input
+//  - nearest_batch answers many queries in Z-order over a pool of
+//    threads (the sort pays off once the tree outgrows the cache);
+//    leaf buckets are scanned from per-axis coordinate arrays
+//  - points can be erased (tombstones); dynamic_kdtree adds inserts by
+//    keeping a forest of static trees of sizes 1, 2, 4, ...
+//  - per-axis loops are unrolled at compile time; Coord may be int or
+//    float to halve memory, distances are long long or double
 //  - worst case for nearest-neighbor may be linear in pathological
 //    case
 //
-// Sonny Chan, Stanford University, April 2009
+// Based on Sonny Chan's KD-tree, Stanford University, April 2009
 // -----------------------------------------------------------------
 
 #include <bits/stdc++.h>
 using namespace std;
 
-// number type for coordinates, and its maximum value
-typedef long long ntype;
-const ntype sentry = numeric_limits<ntype>::max();
+// points are arrays of K coordinates
+template<int K, typename Coord>
+using kdpoint = array<Coord, K>;
 
-// point structure for 2D-tree, can be extended to 3D
-struct point {
-    ntype x, y;
-    point(ntype xx = 0, ntype yy = 0) : x(xx), y(yy) {}
-};
+// squared distances: long long for integer coordinates, double otherwise
+template<typename Coord>
+using kddist = typename conditional<is_integral<Coord>::value, long long, double>::type;
 
-bool operator==(const point &a, const point &b) {
-    return a.x == b.x && a.y == b.y;
+// calls f(0), f(1), ..., f(K - 1), fully unrolled
+template<typename F, size_t... k>
+void unroll_impl(F &&f, index_sequence<k...>) {
+    (f(k), ...);
 }
 
-// sorts points on x-coordinate
-bool on_x(const point &a, const point &b) {
-    return a.x < b.x;
+template<int K, typename F>
+void unroll(F &&f) {
+    unroll_impl(f, make_index_sequence<K>());
 }
 
-// sorts points on y-coordinate
-bool on_y(const point &a, const point &b) {
-    return a.y < b.y;
-}
+// the 2D-tree used by default
+typedef long long ntype;
+typedef kdpoint<2, ntype> point;
 
 // squared distance between points
-ntype pdist2(const point &a, const point &b) {
-    ntype dx = a.x-b.x, dy = a.y-b.y;
-    return dx*dx + dy*dy;
+template<typename Coord, size_t K>
+kddist<Coord> pdist2(const array<Coord, K> &a, const array<Coord, K> &b) {
+    kddist<Coord> s = 0;
+    unroll<K>([&](int k) {
+        kddist<Coord> d = (kddist<Coord>) a[k] - b[k];
+        s += d*d;
+    });
+    return s;
 }
 
 // bounding box for a set of points
-struct bbox {
-    ntype x0, x1, y0, y1;
-    
-    bbox() : x0(sentry), x1(-sentry), y0(sentry), y1(-sentry) {}
-    
-    // computes bounding box from a bunch of points
-    void compute(const vector<point> &v) {
+template<int K, typename Coord>
+struct kdbox {
+    typedef kdpoint<K, Coord> P;
+    typedef kddist<Coord> D;
+    P lo, hi;
+
+    kdbox() {
+        lo.fill(numeric_limits<Coord>::max());
+        hi.fill(numeric_limits<Coord>::lowest());
+    }
+    kdbox(const P &_lo, const P &_hi) : lo(_lo), hi(_hi) {}
+
+    // grows the box to contain p
+    void add(const P &p) {
+        unroll<K>([&](int k) {
+            lo[k] = min(lo[k], p[k]);
+            hi[k] = max(hi[k], p[k]);
+        });
+    }
+
+    bool contains(const P &p) const {
+        bool in = true;
+        unroll<K>([&](int k) { in &= lo[k] <= p[k] && p[k] <= hi[k]; });
+        return in;
+    }
+
+    bool intersects(const kdbox &b) const {
+        bool in = true;
+        unroll<K>([&](int k) { in &= lo[k] <= b.hi[k] && b.lo[k] <= hi[k]; });
+        return in;
+    }
+
+    bool contains(const kdbox &b) const {
+        return contains(b.lo) && contains(b.hi);
+    }
+
+    // widest axis
+    int widest() const {
+        int axis = 0;
+        D w = -1;
+        unroll<K>([&](int k) {
+            D d = (D) hi[k] - lo[k];
+            if (d > w) w = d, axis = k;
+        });
+        return axis;
+    }
+
+    // squared distance between a point and this bbox, 0 if inside
+    D distance(const P &p) const {
+        D s = 0;
+        unroll<K>([&](int k) {
+            D d = p[k] < lo[k] ? (D) lo[k] - p[k] : p[k] > hi[k] ? (D) p[k] - hi[k] : 0;
+            s += d*d;
+        });
+        return s;
+    }
+};
+
+// flat kd-tree: node i covers points [lo, hi), its left child is node i + 1
+// and its right child is node right (-1 for a leaf bucket)
+template<int K = 2, typename Coord = ntype>
+struct kdtree {
+    static const int LEAF = 16;
+    typedef kdpoint<K, Coord> P;
+    typedef kdbox<K, Coord> B;
+    typedef kddist<Coord> D;
+    static constexpr D sentry = numeric_limits<D>::max();
+
+    struct kdnode {
+        B bound;
+        int lo, hi, right;
+    };
+
+    array<vector<Coord>, K> px; // coordinates per axis, reordered so every node is contiguous
+    vector<int> idx;            // idx[i]: input index of point i
+    vector<char> removed;       // by input index
+    vector<kdnode> nodes;
+
+    // constructs a kd-tree from a points (copied here, as it reorders them)
+    kdtree(const vector<P> &vp = {}) : idx(vp.size()), removed(vp.size()) {
+        vector<pair<P, int>> v(vp.size());
+        for (int i = 0; i < (int) vp.size(); ++i) v[i] = {vp[i], i};
+        nodes.reserve(2 * vp.size() / LEAF + 2);
+        if (!v.empty()) build(v, 0, v.size());
+        for (int k = 0; k < K; ++k) px[k].resize(v.size());
         for (int i = 0; i < (int) v.size(); ++i) {
-            x0 = min(x0, v[i].x);   x1 = max(x1, v[i].x);
-            y0 = min(y0, v[i].y);   y1 = max(y1, v[i].y);
+            for (int k = 0; k < K; ++k) px[k][i] = v[i].first[k];
+            idx[i] = v[i].second;
         }
     }
-    
-    // squared distance between a point and this bbox, 0 if inside
-    ntype distance(const point &p) {
-        if (p.x < x0) {
-            if (p.y < y0)       return pdist2(point(x0, y0), p);
-            else if (p.y > y1)  return pdist2(point(x0, y1), p);
-            else                return pdist2(point(x0, p.y), p);
+
+    P at(int i) const {
+        P p;
+        unroll<K>([&](int k) { p[k] = px[k][i]; });
+        return p;
+    }
+
+    // erases input point i from all queries, false if it already was
+    bool erase(int i) {
+        if (removed[i]) return false;
+        removed[i] = true;
+        return true;
+    }
+
+    int build(vector<pair<P, int>> &v, int lo, int hi) {
+        int id = nodes.size();
+        nodes.push_back({B(), lo, hi, -1});
+        B b;
+        for (int i = lo; i < hi; ++i) b.add(v[i].first);
+        nodes[id].bound = b;
+        if (hi - lo <= LEAF) return id;
+
+        // split on the widest axis of the bbox (not best heuristic...)
+        int mid = (lo + hi) / 2, axis = b.widest();
+        nth_element(v.begin() + lo, v.begin() + mid, v.begin() + hi,
+                    [&](const pair<P, int> &u, const pair<P, int> &w) {
+            return u.first[axis] < w.first[axis];
+        });
+        build(v, lo, mid);
+        int right = build(v, mid, hi);
+        nodes[id].right = right;
+        return id;
+    }
+
+    // squared distances from p to points [lo, hi) into d: straight-line
+    // code over the coordinate arrays, so the compiler vectorizes it
+    __attribute__((optimize("tree-vectorize")))
+    void leaf_dist(int lo, int hi, const P &p, D *__restrict d) const {
+        const Coord *c[K];
+        for (int k = 0; k < K; ++k) c[k] = px[k].data() + lo;
+        for (int i = 0; i < hi - lo; ++i) {
+            D s = 0;
+            unroll<K>([&](int k) {
+                D t = (D) c[k][i] - p[k];
+                s += t*t;
+            });
+            d[i] = s;
         }
-        else if (p.x > x1) {
-            if (p.y < y0)       return pdist2(point(x1, y0), p);
-            else if (p.y > y1)  return pdist2(point(x1, y1), p);
-            else                return pdist2(point(x1, p.y), p);
+    }
+
+    // nearest point: best squared distance and its index; iterative, with
+    // the boxes still worth visiting on a small explicit stack
+    void search(const P &p, D &best, int &arg) const {
+        int stk[64];
+        D bound[64], d[LEAF];
+        int top = 0;
+        stk[top] = 0, bound[top++] = 0;
+        while (top) {
+            --top;
+            if (bound[top] >= best) continue;
+            const kdnode &nd = nodes[stk[top]];
+            if (nd.right < 0) {
+                leaf_dist(nd.lo, nd.hi, p, d);
+                for (int i = 0; i < nd.hi - nd.lo; ++i) {
+                    // add "idx[nd.lo + i] != self" here to stop a point finding itself
+                    if (d[i] < best && !removed[idx[nd.lo + i]]) best = d[i], arg = idx[nd.lo + i];
+                }
+                continue;
+            }
+
+            // choose the side with the closest bounding box to search first
+            // (pushed last; the other side is popped later if still needed)
+            int a = stk[top] + 1, b = nd.right;
+            D da = nodes[a].bound.distance(p), db = nodes[b].bound.distance(p);
+            if (db < da) swap(a, b), swap(da, db);
+            if (db < best) stk[top] = b, bound[top++] = db;
+            if (da < best) stk[top] = a, bound[top++] = da;
         }
-        else {
-            if (p.y < y0)       return pdist2(point(p.x, y0), p);
-            else if (p.y > y1)  return pdist2(point(p.x, y1), p);
-            else                return 0;
+    }
+
+    // squared distance to the nearest
+    D nearest(const P &p) const {
+        D best = sentry;
+        int arg = -1;
+        if (!nodes.empty()) search(p, best, arg);
+        return best;
+    }
+
+    // index of the nearest point, -1 if empty
+    int nearest_index(const P &p) const {
+        D best = sentry;
+        int arg = -1;
+        if (!nodes.empty()) search(p, best, arg);
+        return arg;
+    }
+
+    // Z-order key: interleaves the top 64 / K bits of p's position in b
+    static unsigned long long morton(const P &p, const B &b) {
+        const int bits = 64 / K;
+        unsigned long long u[K], key = 0;
+        unroll<K>([&](int k) {
+            double span = (double) b.hi[k] - b.lo[k];
+            double t = span > 0 ? ((double) p[k] - b.lo[k]) / span : 0;
+            u[k] = (unsigned long long) (min(max(t, 0.0), 1.0) * ((1ULL << bits) - 1));
+        });
+        for (int i = bits - 1; i >= 0; --i) {
+            unroll<K>([&](int k) { key = key << 1 | (u[k] >> i & 1); });
         }
+        return key;
     }
-};
 
-// stores a single node of the kd-tree, either internal or leaf
-struct kdnode {
-    bool leaf;      // true if this is a leaf node (has one point)
-    point pt;       // the single point of this is a leaf
-    bbox bound;     // bounding box for set of points in children
-    
-    kdnode *first, *second; // two children of this kd-node
-    
-    kdnode() : leaf(false), first(0), second(0) {}
-    ~kdnode() { if (first) delete first; if (second) delete second; }
-    
-    // intersect a point with this node (returns squared distance)
-    ntype intersect(const point &p) {
-        return bound.distance(p);
-    }
-    
-    // recursively builds a kd-tree from a given cloud of points
-    void construct(vector<point> &vp) {
-        // compute bounding box for points at this node
-        bound.compute(vp);
-        
-        // if we're down to one point, then we're a leaf node
-        if (vp.size() == 1) {
-            leaf = true;
-            pt = vp[0];
-        } else {
-            // split on x if the bbox is wider than high (not best heuristic...)
-            if (bound.x1-bound.x0 >= bound.y1-bound.y0)
-                sort(vp.begin(), vp.end(), on_x);
-            // otherwise split on y-coordinate
-            else
-                sort(vp.begin(), vp.end(), on_y);
-            
-            // divide by taking half the array for each child
-            // (not best performance if many duplicates in the middle)
-            int half = vp.size()/2;
-            vector<point> vl(vp.begin(), vp.begin()+half);
-            vector<point> vr(vp.begin()+half, vp.end());
-            first = new kdnode();   first->construct(vl);
-            second = new kdnode();  second->construct(vr);            
+    // nearest() for many queries: they are visited in Z-order so that
+    // neighbouring queries reuse the same nodes in cache, and threads
+    // claim chunks of that order from a shared counter until none is left
+    vector<D> nearest_batch(const vector<P> &qs, int threads = thread::hardware_concurrency()) const {
+        int q = qs.size();
+        vector<D> res(q, sentry);
+        if (nodes.empty() || q == 0) return res;
+        vector<pair<unsigned long long, int>> order(q);
+        for (int i = 0; i < q; ++i) order[i] = {morton(qs[i], nodes[0].bound), i};
+        sort(order.begin(), order.end());
+
+        const int CHUNK = 256;
+        atomic<int> next(0);
+        auto work = [&] {
+            for (int c; (c = next.fetch_add(CHUNK)) < q; ) {
+                for (int i = c; i < min(q, c + CHUNK); ++i) {
+                    res[order[i].second] = nearest(qs[order[i].second]);
+                }
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t) pool.emplace_back(work);
+        work();
+        for (auto &t : pool) t.join();
+        return res;
+    }
+
+    // heap keeps the k best (squared distance, index) seen so far
+    void search_k(int id, const P &p, int k, priority_queue<pair<D, int>> &heap) const {
+        const kdnode &nd = nodes[id];
+        if (nd.right < 0) {
+            for (int i = nd.lo; i < nd.hi; ++i) {
+                if (removed[idx[i]]) continue;
+                D d = pdist2(p, at(i));
+                if ((int) heap.size() < k) heap.push({d, idx[i]});
+                else if (d < heap.top().first) heap.pop(), heap.push({d, idx[i]});
+            }
+            return;
         }
+        int a = id + 1, b = nd.right;
+        D da = nodes[a].bound.distance(p), db = nodes[b].bound.distance(p);
+        if (db < da) swap(a, b), swap(da, db);
+        if ((int) heap.size() < k || da < heap.top().first) search_k(a, p, k, heap);
+        if ((int) heap.size() < k || db < heap.top().first) search_k(b, p, k, heap);
     }
-};
 
-// simple kd-tree class to hold the tree and handle queries
-struct kdtree {
-    kdnode *root;
-    
-    // constructs a kd-tree from a points (copied here, as it sorts them)
-    kdtree(const vector<point> &vp) {
-        vector<point> v(vp.begin(), vp.end());
-        root = new kdnode();
-        root->construct(v);
-    }
-    ~kdtree() { delete root; }
-    
-    // recursive search method returns squared distance to nearest point
-    ntype search(kdnode *node, const point &p) {
-        if (node->leaf) {
-            // commented special case tells a point not to find itself
-//            if (p == node->pt) return sentry;
-//            else               
-                return pdist2(p, node->pt);
+    // indices of the k nearest points, closest first
+    vector<int> k_nearest(const P &p, int k) const {
+        priority_queue<pair<D, int>> heap;
+        if (!nodes.empty() && k > 0) search_k(0, p, k, heap);
+        vector<int> res(heap.size());
+        for (int i = res.size() - 1; i >= 0; --i) res[i] = heap.top().second, heap.pop();
+        return res;
+    }
+
+    void search_radius(int id, const P &p, D r2, vector<int> &res) const {
+        const kdnode &nd = nodes[id];
+        if (nd.bound.distance(p) > r2) return;
+        if (nd.right < 0) {
+            for (int i = nd.lo; i < nd.hi; ++i) {
+                if (pdist2(p, at(i)) <= r2 && !removed[idx[i]]) res.push_back(idx[i]);
+            }
+            return;
         }
-        
-        ntype bfirst = node->first->intersect(p);
-        ntype bsecond = node->second->intersect(p);
-        
-        // choose the side with the closest bounding box to search first
-        // (note that the other side is also searched if needed)
-        if (bfirst < bsecond) {
-            ntype best = search(node->first, p);
-            if (bsecond < best)
-                best = min(best, search(node->second, p));
-            return best;
-        } else {
-            ntype best = search(node->second, p);
-            if (bfirst < best)
-                best = min(best, search(node->first, p));
-            return best;
+        search_radius(id + 1, p, r2, res);
+        search_radius(nd.right, p, r2, res);
+    }
+
+    // indices of all points at distance <= r from p
+    vector<int> within_radius(const P &p, D r) const {
+        vector<int> res;
+        if (!nodes.empty()) search_radius(0, p, r * r, res);
+        return res;
+    }
+
+    void search_range(int id, const B &q, vector<int> &res) const {
+        const kdnode &nd = nodes[id];
+        if (!q.intersects(nd.bound)) return;
+        if (nd.right < 0 || q.contains(nd.bound)) {
+            for (int i = nd.lo; i < nd.hi; ++i) {
+                if (q.contains(at(i)) && !removed[idx[i]]) res.push_back(idx[i]);
+            }
+            return;
         }
+        search_range(id + 1, q, res);
+        search_range(nd.right, q, res);
     }
-    
-    // squared distance to the nearest 
-    ntype nearest(const point &p) {
-        return search(root, p);
+
+    // indices of all points in the box [lo, hi] (inclusive on every axis)
+    vector<int> in_range(const P &lo, const P &hi) const {
+        vector<int> res;
+        if (!nodes.empty()) search_range(0, B(lo, hi), res);
+        return res;
+    }
+};
+
+// kd-tree under inserts and erases (logarithmic method): level j is empty
+// or a static kdtree of at most 2^j points. An insert merges the full
+// levels 0..j-1 with the new point into level j; an erase leaves a
+// tombstone and rebuilds its level once half of it is dead.
+// Points get ids 0, 1, 2, ... in insertion order.
+// Time: O(lg^2 n) amortized per update, a query searches O(lg n) trees
+template<int K = 2, typename Coord = ntype>
+struct dynamic_kdtree {
+    typedef kdpoint<K, Coord> P;
+    typedef kddist<Coord> D;
+
+    struct level {
+        kdtree<K, Coord> tree;
+        vector<int> ids; // ids[i]: id of the tree's input point i
+        int dead = 0;
+    };
+
+    vector<P> pts;      // by id
+    vector<int> where;  // level holding each id, -1 once erased
+    vector<level> levels;
+
+    // rebuilds level j from the live points of ids
+    void build(int j, const vector<int> &ids) {
+        level &l = levels[j];
+        l.ids.clear();
+        for (int id : ids) if (where[id] >= 0) l.ids.push_back(id), where[id] = j;
+        sort(l.ids.begin(), l.ids.end());
+        vector<P> v(l.ids.size());
+        for (int i = 0; i < (int) v.size(); ++i) v[i] = pts[l.ids[i]];
+        l.tree = kdtree<K, Coord>(v);
+        l.dead = 0;
+    }
+
+    int insert(const P &p) {
+        int id = pts.size();
+        pts.push_back(p);
+        where.push_back(0);
+        vector<int> ids {id};
+        int j = 0;
+        for (; j < (int) levels.size() && !levels[j].ids.empty(); ++j) {
+            ids.insert(ids.end(), levels[j].ids.begin(), levels[j].ids.end());
+            levels[j] = level();
+        }
+        if (j == (int) levels.size()) levels.emplace_back();
+        build(j, ids);
+        return id;
+    }
+
+    // false if id was already erased
+    bool erase(int id) {
+        int j = where[id];
+        if (j < 0) return false;
+        level &l = levels[j];
+        l.tree.erase(lower_bound(l.ids.begin(), l.ids.end(), id) - l.ids.begin());
+        where[id] = -1;
+        if (2 * ++l.dead > (int) l.ids.size()) build(j, vector<int>(l.ids));
+        return true;
+    }
+
+    int size() const {
+        int res = 0;
+        for (const level &l : levels) res += l.ids.size() - l.dead;
+        return res;
+    }
+
+    // squared distance to the nearest live point and its id (-1 if none)
+    pair<D, int> nearest(const P &p) const {
+        pair<D, int> res(kdtree<K, Coord>::sentry, -1);
+        for (const level &l : levels) {
+            D best = res.first;
+            int arg = -1;
+            if (!l.tree.nodes.empty()) l.tree.search(p, best, arg);
+            if (arg >= 0) res = {best, l.ids[arg]};
+        }
+        return res;
     }
 };
 
@@ -175,16 +440,32 @@ int main() {
     // generate some random points for a kd-tree
     vector<point> vp;
     for (int i = 0; i < 100000; ++i) {
-        vp.push_back(point(rand()%100000, rand()%100000));
+        vp.push_back(point {rand()%100000, rand()%100000});
     }
-    kdtree tree(vp);
-    
+    kdtree<> tree(vp);
+
     // query some points
     for (int i = 0; i < 10; ++i) {
-        point q(rand()%100000, rand()%100000);
-        cout << "Closest squared distance to (" << q.x << ", " << q.y << ")"
+        point q {rand()%100000, rand()%100000};
+        cout << "Closest squared distance to (" << q[0] << ", " << q[1] << ")"
              << " is " << tree.nearest(q) << endl;
-    }    
+    }
+
+    // 5 nearest neighbours of one more point, closest first
+    point q {rand()%100000, rand()%100000};
+    for (int i : tree.k_nearest(q, 5)) {
+        cout << "(" << vp[i][0] << ", " << vp[i][1] << ") ";
+    }
+    cout << endl;
+
+    // the same search in 3D with float coordinates
+    vector<kdpoint<3, float>> vp3;
+    for (int i = 0; i < 100000; ++i) {
+        vp3.push_back({rand()%1000 / 10.0f, rand()%1000 / 10.0f, rand()%1000 / 10.0f});
+    }
+    kdtree<3, float> tree3(vp3);
+    cout << "Closest squared distance to (50, 50, 50) is "
+         << tree3.nearest({50, 50, 50}) << endl;
 
     return 0;
 }
@@ -1,3 +1,11 @@
+// Convex hull by Andrew's monotone chain, collinear boundary points kept
+// (duplicates are dropped).
+// convexHull(p, n) works in place: the hull goes to p[0, h), h is returned.
+// Points strictly inside the Akl-Toussaint octagon (extremes along x, y,
+// x + y, x - y) are dropped first, survivors are radix sorted, and large
+// inputs are cut into x-slices whose chain points are found in parallel
+// before the final chain.
+// Time: O(n) filter + O(m log m) on the m survivors (radix for big m)
 struct Point {
     long long x, y;
     bool operator < (const Point &v) const {
@@ -8,18 +16,166 @@ struct Point {
     }
 };
 
-vector<Point> convexHull(vector<Point> p) {
-    sort(p.begin(), p.end());
-    int k = 0, n = p.size();
-    vector<Point> poly (2 * n);
+const int HULL_PARALLEL_MIN = 1 << 16, HULL_RADIX_MIN = 1 << 16;
+
+int hullSlices(int n, int threads) {
+    return threads > 1 && n >= HULL_PARALLEL_MIN ? threads : 1;
+}
+
+// f(t, lo, hi) for slice t of [0, n), slice 0 on the calling thread
+template<typename F>
+void forSlices(int n, int slices, F f) {
+    vector<thread> pool;
+    for (int t = 1; t < slices; ++t) {
+        pool.emplace_back([&f, n, slices, t] { f(t, (long long) n * t / slices, (long long) n * (t + 1) / slices); });
+    }
+    f(0, 0, (long long) n / slices);
+    for (auto &th : pool) th.join();
+}
+
+// moves the points that may be on the hull to the front, returns their count
+int octagonFilter(Point *p, int n, int threads) {
+    // extreme directions in counter-clockwise order
+    static const int cx[8] = {1, 1, 0, -1, -1, -1, 0, 1}, cy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    if (n < 8) return n;
+    int s = hullSlices(n, threads);
+    vector<array<Point, 8>> ext(s);
+    forSlices(n, s, [&](int t, int lo, int hi) {
+        array<Point, 8> &e = ext[t];
+        e.fill(p[lo]);
+        for (int i = lo; i < hi; ++i) {
+            for (int d = 0; d < 8; ++d) {
+                if (cx[d] * p[i].x + cy[d] * p[i].y > cx[d] * e[d].x + cy[d] * e[d].y) e[d] = p[i];
+            }
+        }
+    });
+    array<Point, 8> oct = ext[0];
+    for (int t = 1; t < s; ++t) {
+        for (int d = 0; d < 8; ++d) {
+            if (cx[d] * ext[t][d].x + cy[d] * ext[t][d].y > cx[d] * oct[d].x + cy[d] * oct[d].y) oct[d] = ext[t][d];
+        }
+    }
+
+    // the octagon's proper edges, padded to 8 by repeating the first
+    long long ax[8], ay[8], dx[8], dy[8], area = 0;
+    int m = 0;
+    for (int d = 0; d < 8; ++d) {
+        const Point &a = oct[d], &b = oct[(d + 1) & 7];
+        area += a.x * b.y - a.y * b.x;
+        if (a.x == b.x && a.y == b.y) continue;
+        ax[m] = a.x, ay[m] = a.y, dx[m] = b.x - a.x, dy[m] = b.y - a.y, ++m;
+    }
+    if (area == 0) return n; // flat octagon, nothing is strictly inside
+    for (; m < 8; ++m) ax[m] = ax[0], ay[m] = ay[0], dx[m] = dx[0], dy[m] = dy[0];
+
+    vector<int> kept(s);
+    forSlices(n, s, [&](int t, int lo, int hi) {
+        int k = lo;
+        for (int i = lo; i < hi; ++i) {
+            bool inside = true;
+            for (int e = 0; e < 8; ++e) inside &= dx[e] * (p[i].y - ay[e]) - dy[e] * (p[i].x - ax[e]) > 0;
+            p[k] = p[i];
+            k += !inside;
+        }
+        kept[t] = k - lo;
+    });
+    int k = 0;
+    for (int t = 0; t < s; ++t) {
+        int lo = (long long) n * t / s;
+        move(p + lo, p + lo + kept[t], p + k);
+        k += kept[t];
+    }
+    return k;
+}
+
+// sorts by (x, y): LSD radix on 16-bit digits of the offsets from the minimum
+void radixSort(Point *p, int n) {
+    if (n < HULL_RADIX_MIN) {
+        sort(p, p + n);
+        return;
+    }
+    vector<Point> buf(n);
+    vector<int> cnt(1 << 16);
+    Point *a = p, *b = buf.data();
+    for (int axis = 1; axis >= 0; --axis) {
+        long long lo = LLONG_MAX, hi = LLONG_MIN;
+        for (int i = 0; i < n; ++i) {
+            long long v = axis ? a[i].y : a[i].x;
+            lo = min(lo, v), hi = max(hi, v);
+        }
+        unsigned long long span = (unsigned long long) hi - lo;
+        for (int s = 0; s < 64 && span >> s; s += 16) {
+            auto digit = [&](const Point &q) {
+                return ((unsigned long long) (axis ? q.y : q.x) - lo) >> s & 0xffff;
+            };
+            fill(cnt.begin(), cnt.end(), 0);
+            for (int i = 0; i < n; ++i) ++cnt[digit(a[i])];
+            for (int d = 0, sum = 0; d < 1 << 16; ++d) swap(cnt[d], sum), sum += cnt[d];
+            for (int i = 0; i < n; ++i) b[cnt[digit(a[i])]++] = a[i];
+            swap(a, b);
+        }
+    }
+    if (a != p) copy(a, a + n, p);
+}
+
+// keeps, in order, the points of sorted p[0, n) on its lower or upper chain
+int chainPoints(Point *p, int n) {
+    vector<char> keep(n);
+    vector<int> st(n);
+    for (int dir : {-1, 1}) { // lower chain pops right turns, upper left turns
+        int k = 0;
+        for (int i = 0; i < n; ++i) {
+            while (k >= 2 && dir * p[st[k-2]].cross(p[st[k-1]], p[i]) > 0) --k;
+            st[k++] = i;
+        }
+        for (int j = 0; j < k; ++j) keep[st[j]] = 1;
+    }
+    int k = 0;
+    for (int i = 0; i < n; ++i) if (keep[i]) p[k++] = p[i];
+    return k;
+}
+
+// hull of sorted p[0, n), written back to its front
+int monotoneChain(Point *p, int n) {
+    int k = 0;
+    vector<int> poly (2 * n);
     for(int i = 0; i < n; ++i) {
-        while(k >= 2 && poly[k-2].cross(poly[k-1], p[i]) < 0) --k;
-        poly[k++] = p[i];
+        while(k >= 2 && p[poly[k-2]].cross(p[poly[k-1]], p[i]) < 0) --k;
+        poly[k++] = i;
     }
     for(int i = n-2, t = k+1; i >= 0; --i) {
-        while(k >= t && poly[k-2].cross(poly[k-1], p[i]) < 0) --k;
-        poly[k++] = p[i];
+        while(k >= t && p[poly[k-2]].cross(p[poly[k-1]], p[i]) < 0) --k;
+        poly[k++] = i;
     }
-    poly.resize(min(n, max(0, k - 1)));
-    return poly;
+    int h = min(n, max(0, k - 1));
+    vector<Point> hull(h);
+    for (int j = 0; j < h; ++j) hull[j] = p[poly[j]];
+    copy(hull.begin(), hull.end(), p);
+    return h;
+}
+
+int convexHull(Point *p, int n, int threads = thread::hardware_concurrency()) {
+    n = octagonFilter(p, n, threads);
+    radixSort(p, n);
+    // duplicates would make the chain keep interior points
+    n = unique(p, p + n, [](const Point &a, const Point &b) { return a.x == b.x && a.y == b.y; }) - p;
+    int s = hullSlices(n, threads);
+    if (s > 1) {
+        // chain points of the whole set are chain points of their slice
+        vector<int> kept(s);
+        forSlices(n, s, [&](int t, int lo, int hi) { kept[t] = chainPoints(p + lo, hi - lo); });
+        int k = 0;
+        for (int t = 0; t < s; ++t) {
+            int lo = (long long) n * t / s;
+            move(p + lo, p + lo + kept[t], p + k);
+            k += kept[t];
+        }
+        n = k;
+    }
+    return monotoneChain(p, n);
+}
+
+vector<Point> convexHull(vector<Point> p) {
+    p.resize(convexHull(p.data(), p.size()));
+    return p;
 }
@@ -0,0 +1,91 @@
+// Convex hull under point insertions, uses Point from ConvexHull.cpp.
+// The upper chain is a set ordered by x; the lower chain is kept as the
+// upper chain of the negated points. Each vertex caches the edge to its
+// successor, so the vertex extreme in a direction is one lower_bound.
+// Collinear points are not kept; points on the boundary count as inside.
+// Time: O(log n) amortized insert, O(log n) inside and extreme
+struct DynamicHull {
+    struct Vertex {
+        Point p;
+        mutable long long dx, dy; // edge to the next vertex, 0 for the last
+        bool operator<(const Vertex &o) const { return p.x < o.p.x; }
+        // for a direction d: the edge out of this vertex still gains along d
+        bool operator<(const Point &d) const { return d.x * dx + d.y * dy > 0; }
+    };
+
+    struct Chain : set<Vertex, less<>> {
+        void setEdge(iterator it) {
+            auto nx = next(it);
+            it->dx = nx == end() ? 0 : nx->p.x - it->p.x;
+            it->dy = nx == end() ? 0 : nx->p.y - it->p.y;
+        }
+
+        // p is on or under the chain
+        bool covers(const Point &p) const {
+            if (empty() || p.x < begin()->p.x || p.x > rbegin()->p.x) return false;
+            auto it = lower_bound(Vertex {p, 0, 0});
+            if (it->p.x == p.x) return p.y <= it->p.y;
+            return prev(it)->p.cross(it->p, p) <= 0;
+        }
+
+        void add(const Point &p) {
+            if (covers(p)) return;
+            auto it = find(Vertex {p, 0, 0});
+            if (it != end()) erase(it);
+            it = insert(Vertex {p, 0, 0}).first;
+            // drop neighbours that no longer make a right turn
+            while (next(it) != end() && next(next(it)) != end() && p.cross(next(it)->p, next(next(it))->p) >= 0) {
+                erase(next(it));
+            }
+            while (it != begin() && prev(it) != begin() && prev(prev(it))->p.cross(prev(it)->p, p) >= 0) {
+                erase(prev(it));
+            }
+            if (it != begin()) setEdge(prev(it));
+            setEdge(it);
+        }
+
+        // vertex maximizing dot(d, p), d.y >= 0
+        Point extreme(const Point &d) const {
+            return lower_bound(d)->p;
+        }
+    };
+
+    Chain upper, lower;
+
+    static Point negate(const Point &p) {
+        return {-p.x, -p.y};
+    }
+
+    void insert(const Point &p) {
+        upper.add(p);
+        lower.add(negate(p));
+    }
+
+    bool inside(const Point &p) const {
+        return upper.covers(p) && lower.covers(negate(p));
+    }
+
+    // a hull vertex maximizing dot(d, p), the hull must not be empty
+    Point extreme(const Point &d) const {
+        if (d.y > 0 || (d.y == 0 && d.x >= 0)) return upper.extreme(d);
+        return negate(lower.extreme(negate(d)));
+    }
+
+    // vertices in counter-clockwise order from the lowest leftmost one
+    vector<Point> hull() const {
+        vector<Point> res;
+        auto push = [&](const Point &p) {
+            if (res.empty() || res.back().x != p.x || res.back().y != p.y) res.push_back(p);
+        };
+        for (auto it = lower.rbegin(); it != lower.rend(); ++it) push(negate(it->p));
+        for (auto it = upper.rbegin(); it != upper.rend(); ++it) push(it->p);
+        if (res.size() > 1 && res.back().x == res[0].x && res.back().y == res[0].y) res.pop_back();
+        return res;
+    }
+};
+
+// Example usage:
+// DynamicHull h;
+// h.insert({x, y});
+// if (h.inside(q)) ...
+// Point far = h.extreme({dx, dy});
@@ -0,0 +1,177 @@
+// O(log n) queries on a fixed convex polygon, uses Point from ConvexHull.cpp.
+// Built from a counter-clockwise hull (e.g. convexHull output); collinear
+// vertices are stripped, indices returned refer to the stripped list v.
+//  - inside: fan binary search around v[0], boundary counts as inside
+//  - extreme: edge angles measured from e[0] are sorted, binary search
+//    for the first edge turning past d rotated by 90 degrees
+//  - tangents: a visible edge comes from the fan, an invisible one from
+//    the vertex extreme towards v[0]; two binary searches between them
+//  - diameter2 / width by rotating calipers in O(n)
+// Coordinates up to 1e9 in absolute value do not overflow.
+struct HullIndex {
+    vector<Point> v, e; // e[i] = v[i + 1] - v[i]
+    int n;
+
+    static long long cross(const Point &a, const Point &b) { return a.x * b.y - a.y * b.x; }
+    static long long dot(const Point &a, const Point &b) { return a.x * b.x + a.y * b.y; }
+    static Point sub(const Point &a, const Point &b) { return {a.x - b.x, a.y - b.y}; }
+
+    HullIndex(const vector<Point> &hull) {
+        for (const Point &p : hull) {
+            while (v.size() >= 2 && v[v.size() - 2].cross(v.back(), p) == 0) v.pop_back();
+            v.push_back(p);
+        }
+        while (v.size() >= 3 && v[v.size() - 2].cross(v.back(), v[0]) == 0) v.pop_back();
+        while (v.size() >= 3 && v.back().cross(v[0], v[1]) == 0) v.erase(v.begin());
+        if (v.size() == 2 && v[0].x == v[1].x && v[0].y == v[1].y) v.pop_back();
+        n = v.size();
+        e.resize(n);
+        for (int i = 0; i < n; ++i) e[i] = sub(v[(i + 1) % n], v[i]);
+    }
+
+    bool inside(const Point &p) const {
+        if (n < 3) {
+            if (n == 0) return false;
+            if (n == 1) return p.x == v[0].x && p.y == v[0].y;
+            return v[0].cross(v[1], p) == 0 && dot(sub(p, v[0]), sub(p, v[1])) <= 0;
+        }
+        int a = 1, b = n - 1;
+        if (v[0].cross(v[a], p) < 0 || v[0].cross(v[b], p) > 0) return false;
+        while (b - a > 1) {
+            int c = (a + b) / 2;
+            (v[0].cross(v[c], p) >= 0 ? a : b) = c;
+        }
+        return v[a].cross(v[b], p) >= 0;
+    }
+
+    // angle of a is below angle of b, both measured ccw from e[0] in [0, 2pi)
+    bool before(const Point &a, const Point &b) const {
+        auto half = [&](const Point &w) {
+            long long c = cross(e[0], w);
+            return c < 0 || (c == 0 && dot(e[0], w) < 0);
+        };
+        bool ha = half(a), hb = half(b);
+        return ha != hb ? ha < hb : cross(a, b) > 0;
+    }
+
+    // index of a vertex maximizing dot(d, v[i]), -1 if empty
+    int extreme(const Point &d) const {
+        if (n < 3) {
+            int best = n ? 0 : -1;
+            for (int i = 1; i < n; ++i) if (dot(d, v[i]) > dot(d, v[best])) best = i;
+            return best;
+        }
+        Point t {-d.y, d.x};
+        int lo = 0, hi = n;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (before(e[mid], t)) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo % n;
+    }
+
+    bool visible(int i, const Point &q) const { // edge i, strictly
+        return v[i].cross(v[(i + 1) % n], q) < 0;
+    }
+
+    // first s in [1, len] with visible(from + s) == want; it holds at len
+    int firstSwitch(int from, int len, bool want, const Point &q) const {
+        int lo = 1, hi = len;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (visible((from + mid) % n, q) == want) hi = mid;
+            else lo = mid + 1;
+        }
+        return (from + lo) % n;
+    }
+
+    // tangent vertices {i, j} from q outside the hull: the part of the hull
+    // facing q runs ccw from v[i] to v[j]. {-1, -1} if q is inside.
+    pair<int, int> tangents(const Point &q) const {
+        if (inside(q)) return {-1, -1};
+        if (n < 3) {
+            if (n == 1 || v[0].cross(v[1], q) == 0) {
+                int i = dot(sub(q, v[0]), sub(v[1], v[0])) < 0 ? 0 : 1;
+                return {i, i};
+            }
+            return v[0].cross(v[1], q) < 0 ? make_pair(0, 1) : make_pair(1, 0);
+        }
+
+        int a; // a visible edge
+        if (visible(0, q)) a = 0;
+        else if (v[0].cross(v[n - 1], q) > 0) a = n - 1;
+        else {
+            int lo = 1, hi = n - 1;
+            while (hi - lo > 1) {
+                int c = (lo + hi) / 2;
+                (v[0].cross(v[c], q) >= 0 ? lo : hi) = c;
+            }
+            a = lo;
+        }
+
+        // at the vertex extreme along u = v[0] - q one of the two edges has
+        // its outward normal within 90 degrees of u, so it faces away from q
+        Point u = sub(v[0], q);
+        int w = extreme(u);
+        int b = cross(e[w], u) <= 0 ? w : (w + n - 1) % n;
+
+        int j = firstSwitch(a, (b - a + n) % n, false, q);
+        int i = firstSwitch(b, (a - b + n) % n, true, q);
+        return {i, j};
+    }
+
+    static long long dist2(const Point &a, const Point &b) {
+        Point d = sub(a, b);
+        return dot(d, d);
+    }
+
+    // squared diameter: farthest pair of vertices
+    long long diameter2() const {
+        if (n < 3) return n == 2 ? dist2(v[0], v[1]) : 0;
+        long long best = 0;
+        for (int i = 0, j = 1; i < n; ++i) {
+            int i1 = (i + 1) % n;
+            while (v[i].cross(v[i1], v[(j + 1) % n]) > v[i].cross(v[i1], v[j])) j = (j + 1) % n;
+            best = max({best, dist2(v[i], v[j]), dist2(v[i1], v[j])});
+        }
+        return best;
+    }
+
+    // minimum distance between two parallel lines enclosing the hull
+    double width() const {
+        if (n < 3) return 0;
+        double best = 1e100;
+        for (int i = 0, j = 1; i < n; ++i) {
+            int i1 = (i + 1) % n;
+            while (v[i].cross(v[i1], v[(j + 1) % n]) > v[i].cross(v[i1], v[j])) j = (j + 1) % n;
+            best = min(best, v[i].cross(v[i1], v[j]) / sqrt((double) dot(e[i], e[i])));
+        }
+        return best;
+    }
+
+    // batched queries
+    vector<char> inside(const vector<Point> &qs) const {
+        vector<char> res(qs.size());
+        for (size_t i = 0; i < qs.size(); ++i) res[i] = inside(qs[i]);
+        return res;
+    }
+
+    vector<int> extreme(const vector<Point> &ds) const {
+        vector<int> res(ds.size());
+        for (size_t i = 0; i < ds.size(); ++i) res[i] = extreme(ds[i]);
+        return res;
+    }
+
+    vector<pair<int, int>> tangents(const vector<Point> &qs) const {
+        vector<pair<int, int>> res(qs.size());
+        for (size_t i = 0; i < qs.size(); ++i) res[i] = tangents(qs[i]);
+        return res;
+    }
+};
+
+// Example usage:
+// HullIndex hi(convexHull(points));
+// bool in = hi.inside(q);
+// Point far = hi.v[hi.extreme(d)];
+// auto [i, j] = hi.tangents(q); // q outside
@@ -1,98 +1,171 @@
-const int maxe = 100111, maxv = 100;
-
-// Index from 0, running time O(E*V)
-namespace chuliu {
-    struct Cost;
-    vector<Cost> costlist;
-
-    struct Cost {
-        int id, val, used, a, b, pos;
-        Cost() { val = -1; used = 0; }
-        Cost(int _id, int _val, bool temp) {
-            a = b = -1; id = _id; val = _val; used = 0;
-            pos = costlist.size(); costlist.push_back(*this);
-        }
-        Cost(int _a, int _b) {
-            a = _a; b = _b; id = -1; val = costlist[a].val-costlist[b].val; 
-            used = 0; pos = costlist.size(); costlist.push_back(*this);
-        }
-        void push() {
-            if (id == -1) {
-                costlist[a].used += used;
-                costlist[b].used -= used;
-            }
-        }
+// Directed MST (optimum branching) with Tarjan's contraction, Gabow et al.
+// Every vertex keeps a leftist heap of its in-edges with a lazy offset.
+// Walking cheapest in-edges until a cycle closes, the cycle is contracted in
+// a rollback union-find and its heaps are merged. Undoing the unions in
+// reverse order recovers the original edge entering every vertex.
+// The solver owns all its buffers and init() only resets them, so repeated
+// solves on graphs of similar size do not allocate.
+// Index from 0, running time O(E log V)
+struct DirectedMST {
+    struct Edge {
+        int id, u, v;
+        long long c;
     };
 
-    struct Edge {
-        int u, v;
-        Cost cost;
-        Edge() {}
-        Edge(int id, int _u, int _v, int c) {
-            u = _u; v = _v; cost = Cost(id, c, 0);
-        }
-    } edge[maxe];
+    struct Node { // heap node e + 1 is edge e, 0 is nil
+        int l, r, height;
+        long long key, lazy;
+    };
+
+    struct Cycle {
+        int u, time, lo, hi; // contracted into u, its edges are cyc[lo, hi)
+    };
 
-    int n, m, root, pre[maxv], node[maxv], vis[maxv], best[maxv];
+    int n;
+    vector<Edge> edge;
+    vector<Node> t;
+    vector<int> uf; // no path compression, uf[x] < 0: root of size -uf[x]
+    vector<pair<int, int>> history;
+    vector<int> heap, seen, path, Q, cyc;
+    vector<Cycle> cycles;
+    vector<int> in; // edge entering each vertex, -1 for the root
+    vector<char> used;
 
     void init(int _n) {
-        n = _n; m = 0;
-        costlist.clear();
+        n = _n;
+        edge.clear();
     }
 
     void add(int id, int u, int v, int c) {
-        edge[m++] = Edge(id, u, v, c);
+        if (u != v) edge.push_back({id, u, v, c});
     }
 
-    int mst(int root) {
-        int ret = 0;
-        while (true) {
-            REP(i, n) best[i] = -1;
-            REP(e, m) {
-                int u = edge[e].u, v = edge[e].v;
-                if ((best[v] == -1 || edge[e].cost.val < costlist[best[v]].val) && u != v) {
-                    pre[v] = u;
-                    best[v] = edge[e].cost.pos;
-                }
-            }
-            REP(i, n) if (i != root && best[i] == -1) return -1;
-            int cntnode = 0;
-            memset(node, -1, sizeof node); memset(vis, -1, sizeof vis);
-            REP(i, n) if (i != root) {
-                ret += costlist[best[i]].val;
-                costlist[best[i]].used++;
-                int v = i;
-                while (vis[v] != i && node[v] == -1 && v != root) {
-                    vis[v] = i;
-                    v = pre[v];
+    void apply(int a, long long d) {
+        if (a) t[a].key += d, t[a].lazy += d;
+    }
+
+    void push(int a) {
+        if (t[a].lazy) {
+            apply(t[a].l, t[a].lazy);
+            apply(t[a].r, t[a].lazy);
+            t[a].lazy = 0;
+        }
+    }
+
+    int merge(int a, int b) {
+        if (!a || !b) return a ^ b;
+        if (t[b].key < t[a].key) swap(a, b);
+        push(a);
+        t[a].r = merge(t[a].r, b);
+        if (t[t[a].l].height < t[t[a].r].height) swap(t[a].l, t[a].r);
+        t[a].height = t[t[a].r].height + 1;
+        return a;
+    }
+
+    int pop(int a) {
+        push(a);
+        return merge(t[a].l, t[a].r);
+    }
+
+    int find(int x) {
+        while (uf[x] >= 0) x = uf[x];
+        return x;
+    }
+
+    bool join(int a, int b) {
+        a = find(a), b = find(b);
+        if (a == b) return false;
+        if (uf[a] > uf[b]) swap(a, b);
+        history.push_back({a, uf[a]});
+        history.push_back({b, uf[b]});
+        uf[a] += uf[b];
+        uf[b] = a;
+        return true;
+    }
+
+    void rollback(int time) {
+        while ((int) history.size() > time) {
+            uf[history.back().first] = history.back().second;
+            history.pop_back();
+        }
+    }
+
+    // total cost, -1 if some vertex is unreachable from root
+    long long mst(int root) {
+        int m = edge.size();
+        t.assign(m + 1, Node {0, 0, 0, 0, 0});
+        heap.assign(n, 0);
+        REP(e, m) {
+            t[e + 1].key = edge[e].c;
+            t[e + 1].height = 1;
+            heap[edge[e].v] = merge(heap[edge[e].v], e + 1);
+        }
+        uf.assign(n, -1);
+        history.clear();
+        in.assign(n, -1);
+        seen.assign(n, -1);
+        path.resize(n);
+        Q.resize(n);
+        cyc.clear();
+        cycles.clear();
+
+        long long ret = 0;
+        seen[root] = root;
+        REP(s, n) {
+            int u = s, qi = 0, w;
+            while (seen[u] < 0) {
+                if (!heap[u]) return -1;
+                int e = heap[u] - 1;
+                if (find(edge[e].u) == u) { // inside a contracted cycle
+                    heap[u] = pop(heap[u]);
+                    continue;
                 }
-                if (v != root && node[v] == -1) {
-                    for (int u = pre[v]; u != v; u = pre[u]) node[u] = cntnode;
-                    node[v] = cntnode++;
+                long long c = t[heap[u]].key;
+                apply(heap[u], -c);
+                heap[u] = pop(heap[u]);
+                Q[qi] = e, path[qi++] = u, seen[u] = s;
+                ret += c;
+                u = find(edge[e].u);
+                if (seen[u] == s) { // closed a cycle, contract it
+                    int merged = 0, end = qi, time = history.size();
+                    do merged = merge(merged, heap[w = path[--qi]]);
+                    while (join(u, w));
+                    u = find(u), heap[u] = merged, seen[u] = -1;
+                    cycles.push_back({u, time, (int) cyc.size(), (int) cyc.size() + end - qi});
+                    cyc.insert(cyc.end(), Q.begin() + qi, Q.begin() + end);
                 }
             }
-            if (cntnode == 0) break;
-            REP(i, n) if (node[i] == -1) node[i] = cntnode++;
-            REP(e, m) {
-                int v = edge[e].v;
-                edge[e].u = node[edge[e].u];
-                edge[e].v = node[edge[e].v];
-                if (edge[e].u != edge[e].v) edge[e].cost = Cost(edge[e].cost.pos, best[v]);
-            }
-            n = cntnode;
-            root = node[root];
+            REP(i, qi) in[find(edge[Q[i]].v)] = Q[i];
         }
 
+        // expand cycles, last contracted first
+        FORD(k, (int) cycles.size() - 1, 0) {
+            Cycle &c = cycles[k];
+            rollback(c.time);
+            int enter = in[c.u];
+            for (int i = c.lo; i < c.hi; ++i) in[find(edge[cyc[i]].v)] = cyc[i];
+            in[find(edge[enter].v)] = enter;
+        }
         return ret;
     }
 
+    // ids of the chosen edges after mst(), in the order they were added
+    void trace(vector<int> &ret) {
+        used.assign(edge.size(), 0);
+        REP(v, n) if (in[v] >= 0) used[in[v]] = 1;
+        ret.clear();
+        REP(e, (int) edge.size()) if (used[e]) ret.push_back(edge[e].id);
+    }
+
     vector<int> trace() {
         vector<int> ret;
-        FORD(i, costlist.size()-1,0) costlist[i].push();
-        REP(i, costlist.size()) {
-            Cost cost = costlist[i];
-            if (cost.id != -1 && cost.used > 0) ret.push_back(cost.id);
-        }
+        trace(ret);
         return ret;
     }
-}
+};
+
+// Example usage (reuse one solver across graphs):
+// DirectedMST g;
+// g.init(n); g.add(id, u, v, c); ...
+// long long cost = g.mst(root);
+// vector<int> ids = g.trace();
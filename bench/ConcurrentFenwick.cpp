@@ -0,0 +1,62 @@
+// ConcurrentFenwickTree against one FenwickTree behind a single mutex
+// g++ -O2 -std=c++17 -pthread bench/ConcurrentFenwick.cpp && ./a.out [n]
+// Every thread runs the same share of update_range calls, with one get in 16.
+// The sharded trees get one shard per thread. Reported in Mops (all threads).
+#include <bits/stdc++.h>
+using namespace std;
+#include "../DataStructure/FenwickTree.cpp"
+#include "../DataStructure/ConcurrentFenwickTree.cpp"
+
+struct LockedFenwick {
+    FenwickTree<long long> ft;
+    mutex mtx;
+
+    LockedFenwick(int n, int): ft(n) {
+    }
+
+    void update_range(int l, int r, long long val) {
+        lock_guard<mutex> lock(mtx);
+        ft.update_range(l, r, val);
+    }
+
+    long long get(int x) {
+        lock_guard<mutex> lock(mtx);
+        return ft.get(x);
+    }
+};
+
+template<typename Tree>
+double mops(int n, int threads, long long ops) {
+    Tree ft(n, threads);
+    vector<thread> pool;
+    atomic<long long> sink(0);
+    auto t0 = chrono::steady_clock::now();
+    for (int k = 0; k < threads; ++k) {
+        pool.emplace_back([&, k] {
+            mt19937 rng(k + 1);
+            long long s = 0;
+            for (long long i = 0; i < ops / threads; ++i) {
+                int l = rng() % n + 1, r = rng() % n + 1;
+                if (l > r) swap(l, r);
+                if (i % 16 == 15) s += ft.get(r);
+                else ft.update_range(l, r, 1);
+            }
+            sink += s;
+        });
+    }
+    for (auto &t : pool) t.join();
+    return ops / chrono::duration<double>(chrono::steady_clock::now() - t0).count() / 1e6;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    const long long ops = 8000000;
+    printf("n = %d, %u hardware threads\n", n, thread::hardware_concurrency());
+    printf("threads  mutex  sharded  sharded-linearizable\n");
+    for (int threads : {1, 2, 4, 8, 16, 32}) {
+        printf("%7d  %5.2f  %7.2f  %20.2f\n", threads,
+               mops<LockedFenwick>(n, threads, ops),
+               mops<ConcurrentFenwickTree<long long, false>>(n, threads, ops),
+               mops<ConcurrentFenwickTree<long long, true>>(n, threads, ops));
+    }
+}
@@ -0,0 +1,58 @@
+// FenwickTree layout: interleaved {mul, add} cells against two separate arrays
+// g++ -O2 -std=c++17 bench/FenwickLayout.cpp && ./a.out [n ...]
+// Each n runs the same random update_range / get mix on both layouts.
+#include <bits/stdc++.h>
+using namespace std;
+#include "../DataStructure/FenwickTree.cpp"
+
+// the layout before cells were interleaved
+struct SplitFenwick {
+    vector<long long> tmul, tadd;
+    int n;
+
+    SplitFenwick(int _n): tmul (_n + 1), tadd (_n + 1), n (_n) {
+    }
+
+    void update_point(int x, long long mul, long long add) {
+        for (; x <= n; x += x & (-x)) tmul[x] += mul, tadd[x] += add;
+    }
+
+    void update_range(int l, int r, long long val) {
+        update_point(l, val, -val * (l - 1));
+        update_point(r, -val, val * r);
+    }
+
+    long long get(int x) {
+        long long mul = 0, add = 0;
+        for (int y = x; y; y &= y - 1) mul += tmul[y], add += tadd[y];
+        return mul * x + add;
+    }
+};
+
+template<typename Tree>
+double run(int n, int ops, long long &check) {
+    Tree ft(n);
+    mt19937 rng(1);
+    auto t0 = chrono::steady_clock::now();
+    for (int i = 0; i < ops; ++i) {
+        int l = rng() % n + 1, r = rng() % n + 1;
+        if (l > r) swap(l, r);
+        if (i & 1) check += ft.get(r);
+        else ft.update_range(l, r, rng() % 1000);
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+    vector<int> ns = {100000, 10000000};
+    if (argc > 1) ns.clear();
+    for (int i = 1; i < argc; ++i) ns.push_back(atoi(argv[i]));
+    const int ops = 10000000;
+    for (int n : ns) {
+        long long a = 0, b = 0;
+        double ti = run<FenwickTree<long long>>(n, ops, a);
+        double ts = run<SplitFenwick>(n, ops, b);
+        printf("n = %d, %d ops: interleaved %.2f s, two arrays %.2f s%s\n",
+               n, ops, ti, ts, a == b ? "" : " (MISMATCH)");
+    }
+}
@@ -0,0 +1,33 @@
+// kdtree: nearest_batch (Z-ordered, threaded) against a plain loop of nearest()
+// g++ -O2 -std=c++17 -pthread bench/KdNearest.cpp && ./a.out [points queries]
+// Uniform random 2D points and queries in [0, 1e9)^2, queries in random order.
+#define main kd_main // kdTree.cpp carries its own demo main
+#include "../DataStructure/kdTree.cpp"
+#undef main
+
+double since(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 2 ? atoi(argv[1]) : 2000000, q = argc > 2 ? atoi(argv[2]) : 1000000;
+    mt19937_64 rng(18);
+    auto rnd = [&] { return point{(ntype) (rng() % 1000000000), (ntype) (rng() % 1000000000)}; };
+    vector<point> pts(n), qs(q);
+    for (auto &p : pts) p = rnd();
+    for (auto &p : qs) p = rnd();
+    kdtree<> tree(pts);
+    printf("%d points, %d queries, %u hardware threads\n", n, q, thread::hardware_concurrency());
+
+    auto t0 = chrono::steady_clock::now();
+    vector<ntype> loop(q);
+    for (int i = 0; i < q; ++i) loop[i] = tree.nearest(qs[i]);
+    printf("  nearest() loop          %.2f s\n", since(t0));
+
+    for (int threads : {1, (int) thread::hardware_concurrency()}) {
+        t0 = chrono::steady_clock::now();
+        vector<ntype> batch = tree.nearest_batch(qs, threads);
+        printf("  nearest_batch, %d thr   %.2f s%s\n", threads, since(t0), batch == loop ? "" : "  (MISMATCH)");
+        if (thread::hardware_concurrency() <= 1) break;
+    }
+}
@@ -0,0 +1,54 @@
+// BlockedRMQ2D against SparseTable2D: memory, build time, query time
+// g++ -O2 -std=c++17 -pthread bench/RMQ2D.cpp && ./a.out [side ...]
+// Square int grids with random values, 1e6 random rectangle queries each.
+// SparseTable2D is skipped (size only) when its table would exceed 2 GB.
+#include <bits/stdc++.h>
+using namespace std;
+#include "../DataStructure/SparseTable2D.cpp"
+#include "../DataStructure/BlockedRMQ2D.cpp"
+
+double since(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+    vector<int> sides = {256, 1024, 4096};
+    if (argc > 1) sides.clear();
+    for (int i = 1; i < argc; ++i) sides.push_back(atoi(argv[i]));
+    const int Q = 1000000;
+    for (int s : sides) {
+        mt19937 rng(s);
+        vector<vector<int>> a(s, vector<int>(s));
+        for (auto &row : a) for (int &x : row) x = rng();
+        vector<array<int, 4>> qs(Q);
+        for (auto &q : qs) {
+            int r1 = rng() % s, r2 = rng() % s, c1 = rng() % s, c2 = rng() % s;
+            q = {min(r1, r2), min(c1, c2), max(r1, r2), max(c1, c2)};
+        }
+        printf("%d x %d\n", s, s);
+
+        auto t0 = chrono::steady_clock::now();
+        BlockedRMQ2D<int> blk(a);
+        double build = since(t0);
+        size_t bytes = blk.val.size() * sizeof(int) + blk.mask.size() * sizeof(unsigned) + blk.bst.size() * sizeof(int);
+        long long sum = 0;
+        t0 = chrono::steady_clock::now();
+        for (auto &q : qs) sum += blk.query(q[0], q[1], q[2], q[3]);
+        printf("  BlockedRMQ2D   %8.1f MB  build %.2f s  queries %.2f s\n", bytes / 1e6, build, since(t0));
+
+        int lg = 31 - __builtin_clz(s) + 1;
+        double table = (double) lg * lg * s * s * sizeof(int);
+        if (table > 2e9) {
+            printf("  SparseTable2D  %8.1f MB  (not built)\n", table / 1e6);
+            continue;
+        }
+        t0 = chrono::steady_clock::now();
+        SparseTable2D<int> st(a, 1);
+        build = since(t0);
+        long long sum2 = 0;
+        t0 = chrono::steady_clock::now();
+        for (auto &q : qs) sum2 += st.query(q[0], q[1], q[2], q[3]);
+        printf("  SparseTable2D  %8.1f MB  build %.2f s  queries %.2f s%s\n", st.st.size() * sizeof(int) / 1e6,
+               build, since(t0), sum == sum2 ? "" : "  (MISMATCH)");
+    }
+}
@@ -6,6 +6,8 @@ tex_file = open("part1.tex").readlines()
 # Collect all code files
 code_files = []
 for (dirpath, dirnames, filenames) in os.walk('.'):
+    # bench/ holds benchmark drivers, not notebook code
+    dirnames[:] = [d for d in dirnames if d != 'bench']
     for x in filenames:
         if x.split('.')[-1] in ["cpp", "java", "sh"]:
             code_files.append((x.split('.')[0], os.path.join(dirpath, x).replace('\\', '/')))